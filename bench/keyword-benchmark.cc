@@ -0,0 +1,158 @@
+/**
+ * Keyword lookup microbenchmark.
+ *
+ * Looks up every keyword, in mixed case, and as many identifiers that are not keywords,
+ * with the scanner's hash table and with the `std::map` it replaced,
+ * and reports nanoseconds per lookup for both as JSON on stdout.
+ *
+ * Usage: keyword_benchmark [--lookups N] [--iterations N]
+ */
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "keyword-lookup.cc"
+
+namespace {
+    /**
+     * The lookup the hash table replaced: upper-case the identifier, then search a `std::map`.
+     */
+    struct MapKeywordLookup {
+        std::map<std::string, int> keyword2TokenType;
+
+        MapKeywordLookup () {
+            for (const auto &entry : keywordEntries) {
+                keyword2TokenType[entry.text] = entry.tokenType;
+            }
+        }
+
+        int tryGetKeywordTokenType (std::string const &str) const {
+            std::string upper(str);
+            for (auto &ch : upper) {
+                ch = static_cast<char>(toUpperAscii(static_cast<unsigned char>(ch)));
+            }
+            auto it = keyword2TokenType.find(upper);
+            if (it == keyword2TokenType.end()) {
+                return -1;
+            } else {
+                return it->second;
+            }
+        }
+    };
+
+    /**
+     * Every keyword with every other letter lower-cased,
+     * and as many identifiers made from common column name parts.
+     * Deterministic, so runs on different machines and commits see the same input.
+     */
+    std::vector<std::string> makeWords () {
+        static const char *parts[] = {
+            "customer", "order", "id", "created", "at", "total", "t1", "x",
+            "name", "updated", "by", "the_longer_identifier", "utf8mb4", "status"
+        };
+        const size_t partCount = sizeof(parts) / sizeof(parts[0]);
+
+        std::vector<std::string> result;
+        for (const auto &entry : keywordEntries) {
+            std::string word(entry.text);
+            for (size_t i=1; i<word.size(); i+=2) {
+                word[i] = static_cast<char>(tolower(static_cast<unsigned char>(word[i])));
+            }
+            result.push_back(word);
+        }
+        auto keywordCount = result.size();
+        for (size_t i=0; i<keywordCount; ++i) {
+            std::string word(parts[i % partCount]);
+            if (i >= partCount) {
+                word += "_";
+                word += parts[(i / partCount) % partCount];
+            }
+            result.push_back(word);
+        }
+        return result;
+    }
+
+    template <typename Function>
+    double bestSeconds (unsigned iterations, Function function) {
+        double result = 0;
+        for (unsigned i=0; i<iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (i == 0 || elapsed.count() < result) {
+                result = elapsed.count();
+            }
+        }
+        return result;
+    }
+}
+
+int main (int argc, char **argv) {
+    size_t lookups = 4 * 1000 * 1000;
+    unsigned iterations = 3;
+
+    for (int i=1; i<argc; ++i) {
+        if (strcmp(argv[i], "--lookups") == 0 && i + 1 < argc) {
+            lookups = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            fprintf(stderr, "Usage: %s [--lookups N] [--iterations N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    if (lookups == 0) {
+        lookups = 1;
+    }
+
+    auto words = makeWords();
+    MapKeywordLookup mapLookup;
+
+    //Both lookups must agree, or the comparison means nothing
+    for (auto const &word : words) {
+        if (tryGetKeywordTokenType(word.data(), word.size()) != mapLookup.tryGetKeywordTokenType(word)) {
+            fprintf(stderr, "Lookups disagree on %s\n", word.c_str());
+            return 1;
+        }
+    }
+
+    //Summed, so the lookups are not optimized away
+    long hashSum = 0;
+    auto hashSeconds = bestSeconds(iterations, [&] () {
+        for (size_t i=0; i<lookups; ++i) {
+            auto const &word = words[i % words.size()];
+            hashSum += tryGetKeywordTokenType(word.data(), word.size());
+        }
+    });
+    long mapSum = 0;
+    auto mapSeconds = bestSeconds(iterations, [&] () {
+        for (size_t i=0; i<lookups; ++i) {
+            mapSum += mapLookup.tryGetKeywordTokenType(words[i % words.size()]);
+        }
+    });
+
+    printf(
+        "{\n"
+        "  \"lookups\": %zu,\n"
+        "  \"iterations\": %u,\n"
+        "  \"words\": %zu,\n"
+        "  \"hashTable\": { \"nsPerLookup\": %.2f, \"checksum\": %ld },\n"
+        "  \"map\": { \"nsPerLookup\": %.2f, \"checksum\": %ld }\n"
+        "}\n",
+        lookups,
+        iterations,
+        words.size(),
+        hashSeconds * 1e9 / lookups,
+        hashSum,
+        mapSeconds * 1e9 / lookups,
+        mapSum
+    );
+    return 0;
+}
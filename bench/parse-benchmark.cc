@@ -0,0 +1,307 @@
+/**
+ * Parse throughput benchmark over synthetic SQL corpora.
+ *
+ * For every corpus, reports the throughput of the standalone tokenizer
+ * and of a full tree-sitter parse, as JSON on stdout.
+ *
+ * If the scanner was compiled with `SCANNER_STATS`, the parse also reports
+ * how many times tree-sitter called the external scanner per token of the input.
+ *
+ * Usage: parse_benchmark [--size-mb N] [--iterations N] [--corpus NAME]
+ */
+#include <tree_sitter/api.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "scanner-stats.h"
+#include "tokenizer.h"
+
+extern "C" const TSLanguage *tree_sitter_YOUR_LANGUAGE_NAME(void);
+
+namespace {
+    /**
+     * Deterministic, so runs on different machines and commits see the same input.
+     */
+    struct Random {
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+
+        uint64_t next () {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+    };
+
+    struct Corpus {
+        const char *name;
+        std::function<void(std::string &, size_t, Random &)> appendStatement;
+    };
+
+    void appendHex (std::string &out, size_t length, Random &random) {
+        static const char alphabet[] = "0123456789abcdefABCDEF";
+        for (size_t i=0; i<length; ++i) {
+            out += alphabet[random.next() % 22];
+        }
+    }
+
+    void appendBase64 (std::string &out, size_t length, Random &random) {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (size_t i=0; i<length; ++i) {
+            out += alphabet[random.next() % 64];
+        }
+    }
+
+    const std::vector<Corpus> corpora = {
+        {
+            "keyword-dense-ddl",
+            [] (std::string &out, size_t i, Random &) {
+                out += "CREATE SCHEMA IF NOT EXISTS schema_" + std::to_string(i);
+                out += " DEFAULT CHARACTER SET = utf8mb4 DEFAULT COLLATE = utf8mb4_unicode_ci;\n";
+            }
+        },
+        {
+            "huge-binlog-literals",
+            [] (std::string &out, size_t, Random &random) {
+                out += "BINLOG '";
+                appendBase64(out, 256 * 1024, random);
+                out += "';\n";
+            }
+        },
+        {
+            "huge-string-literals",
+            [] (std::string &out, size_t, Random &) {
+                out += "CREATE SCHEMA s DEFAULT CHARACTER SET '";
+                for (size_t j=0; j<4096; ++j) {
+                    out += "it''s a \\'string\\' ";
+                }
+                out += "';\n";
+            }
+        },
+        {
+            "comment-heavy",
+            [] (std::string &out, size_t i, Random &) {
+                out += "/*\n * Table structure for schema_" + std::to_string(i) + "\n";
+                out += " * generated by a dump tool, with a fairly long comment line here\n */\n";
+                out += "/*!40101 SET character_set_client = utf8 */\n";
+                out += "CREATE SCHEMA schema_" + std::to_string(i) + "; /* trailing comment */\n";
+            }
+        },
+        {
+            "delimiter-switches",
+            [] (std::string &out, size_t i, Random &) {
+                out += "DELIMITER $$\n";
+                out += "CREATE SCHEMA schema_" + std::to_string(i) + "$$\n";
+                out += "DELIMITER ;\n";
+                out += "DELIMITER /*!*/;\n";
+                out += "BINLOG 'AAAA'/*!*/;\n";
+                out += "DELIMITER ;\n";
+            }
+        },
+        {
+            /**
+             * Integer, decimal, real, hex and bit literals, as many digits as a numeric dump has
+             */
+            "number-literals",
+            [] (std::string &out, size_t i, Random &random) {
+                out += "DO " + std::to_string(i);
+                out += ", " + std::to_string(random.next() % 100000) + "." + std::to_string(random.next() % 1000);
+                out += ", " + std::to_string(random.next() % 1000) + ".";
+                out += ", " + std::to_string(random.next() % 10) + "." + std::to_string(random.next() % 100);
+                out += "e-" + std::to_string(random.next() % 40);
+                out += ", " + std::to_string(random.next() % 1000) + "E" + std::to_string(random.next() % 300);
+                out += ", 0x";
+                appendHex(out, 1 + random.next() % 16, random);
+                out += ", 0b";
+                for (size_t k=random.next() % 16; k<16; ++k) {
+                    out += (random.next() & 1) ? '1' : '0';
+                }
+                out += ";\n";
+            }
+        },
+        {
+            /**
+             * Like the literal columns of a binary dump
+             */
+            "hex-literals",
+            [] (std::string &out, size_t, Random &random) {
+                out += "DO";
+                for (size_t j=0; j<16; ++j) {
+                    if (j > 0) {
+                        out += ",";
+                    }
+                    switch (random.next() % 3) {
+                        case 0:
+                            out += " 0x";
+                            appendHex(out, 1 + random.next() % 32, random);
+                            break;
+                        case 1:
+                            out += " x'";
+                            appendHex(out, 2 * (1 + random.next() % 16), random);
+                            out += "'";
+                            break;
+                        default:
+                            out += " b'";
+                            for (size_t k=random.next() % 32; k<32; ++k) {
+                                out += (random.next() & 1) ? '1' : '0';
+                            }
+                            out += "'";
+                            break;
+                    }
+                }
+                out += ";\n";
+            }
+        },
+        {
+            "long-quoted-identifiers",
+            [] (std::string &out, size_t i, Random &) {
+                out += "CREATE SCHEMA `";
+                for (size_t j=0; j<16; ++j) {
+                    out += "a_rather_long_quoted_identifier_part``";
+                }
+                out += std::to_string(i) + "`;\n";
+            }
+        },
+    };
+
+    /**
+     * Each corpus gets its own `Random`, so `--corpus NAME` sees the same input as a full run.
+     */
+    std::string generate (Corpus const &corpus, size_t targetSize) {
+        Random random;
+        std::string result;
+        result.reserve(targetSize + 1024 * 1024);
+        for (size_t i=0; result.size() < targetSize; ++i) {
+            corpus.appendStatement(result, i, random);
+        }
+        return result;
+    }
+
+    /**
+     * `scan()` calls since the last reset, per token of the input,
+     * or a negative number if the scanner was compiled without `SCANNER_STATS`.
+     * `tokenCount` is the number of tokens all parses since the reset kept.
+     * More than 1 means tree-sitter scanned the same input more than once.
+     */
+    double scansPerToken (uint64_t tokenCount) {
+        YourLanguageNameScannerStats stats;
+        if (!tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_stats(&stats)) {
+            return -1;
+        }
+        if (tokenCount == 0) {
+            return 0;
+        }
+        return static_cast<double>(stats.scan_calls) / tokenCount;
+    }
+
+    template <typename Function>
+    double bestSeconds (unsigned iterations, Function function) {
+        double result = 0;
+        for (unsigned i=0; i<iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (i == 0 || elapsed.count() < result) {
+                result = elapsed.count();
+            }
+        }
+        return result;
+    }
+}
+
+int main (int argc, char **argv) {
+    size_t sizeMb = 8;
+    unsigned iterations = 3;
+    const char *onlyCorpus = nullptr;
+
+    for (int i=1; i<argc; ++i) {
+        if (strcmp(argv[i], "--size-mb") == 0 && i + 1 < argc) {
+            sizeMb = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            onlyCorpus = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--size-mb N] [--iterations N] [--corpus NAME]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, tree_sitter_YOUR_LANGUAGE_NAME());
+
+    printf("{\n  \"sizeMb\": %zu,\n  \"iterations\": %u,\n  \"corpora\": [", sizeMb, iterations);
+    bool first = true;
+    for (auto const &corpus : corpora) {
+        if (onlyCorpus != nullptr && strcmp(onlyCorpus, corpus.name) != 0) {
+            continue;
+        }
+
+        auto input = generate(corpus, sizeMb * 1024 * 1024);
+        auto megabytes = static_cast<double>(input.size()) / (1024 * 1024);
+
+        std::vector<YOUR_LANGUAGE_NAME::Token> tokens;
+        tokens.reserve(input.size() / 4);
+        auto tokenizeSeconds = bestSeconds(iterations, [&] () {
+            YOUR_LANGUAGE_NAME::Tokenizer tokenizer;
+            tokens.clear();
+            tokenizer.tokenize(input.data(), input.size(), tokens);
+        });
+
+        //Timing error recovery would say nothing about the grammar's happy path
+        TSTree *checkTree = ts_parser_parse_string(parser, nullptr, input.data(), static_cast<uint32_t>(input.size()));
+        bool hasError = ts_node_has_error(ts_tree_root_node(checkTree));
+        ts_tree_delete(checkTree);
+        if (hasError) {
+            fprintf(stderr, "Corpus %s does not parse without errors\n", corpus.name);
+            ts_parser_delete(parser);
+            return 1;
+        }
+
+        tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_reset_stats();
+        auto parseSeconds = bestSeconds(iterations, [&] () {
+            TSTree *tree = ts_parser_parse_string(parser, nullptr, input.data(), static_cast<uint32_t>(input.size()));
+            ts_tree_delete(tree);
+        });
+        //Every parse keeps one tree leaf per token the tokenizer found
+        auto parseScansPerToken = scansPerToken(static_cast<uint64_t>(tokens.size()) * iterations);
+        char scansPerTokenJson[64] = "";
+        if (parseScansPerToken >= 0) {
+            snprintf(scansPerTokenJson, sizeof(scansPerTokenJson), ", \"scansPerToken\": %.4f", parseScansPerToken);
+        }
+
+        printf(
+            "%s\n    {\n"
+            "      \"name\": \"%s\",\n"
+            "      \"bytes\": %zu,\n"
+            "      \"tokens\": %zu,\n"
+            "      \"tokenizer\": { \"seconds\": %.6f, \"mbPerSecond\": %.2f, \"tokensPerSecond\": %.0f },\n"
+            "      \"parse\": { \"seconds\": %.6f, \"mbPerSecond\": %.2f, \"tokensPerSecond\": %.0f%s }\n"
+            "    }",
+            first ? "" : ",",
+            corpus.name,
+            input.size(),
+            tokens.size(),
+            tokenizeSeconds,
+            megabytes / tokenizeSeconds,
+            tokens.size() / tokenizeSeconds,
+            parseSeconds,
+            megabytes / parseSeconds,
+            tokens.size() / parseSeconds,
+            scansPerTokenJson
+        );
+        fflush(stdout);
+        first = false;
+    }
+    printf("\n  ]\n}\n");
+
+    ts_parser_delete(parser);
+    return 0;
+}
@@ -2,18 +2,87 @@
   "targets": [
     {
       "target_name": "tree_sitter_YOUR_LANGUAGE_NAME_binding",
+      "dependencies": [
+        "tree_sitter_YOUR_LANGUAGE_NAME_native"
+      ],
       "include_dirs": [
         "<!(node -e \"require('nan')\")",
         "src"
       ],
       "sources": [
-        "bindings/node/binding.cc",
+        "bindings/node/binding.cc"
+        # The parser and scanner come from tree_sitter_YOUR_LANGUAGE_NAME_native
+      ]
+    },
+    {
+      # Parser, scanner and the tree-sitter runtime, for native tools
+      "target_name": "tree_sitter_YOUR_LANGUAGE_NAME_native",
+      "type": "static_library",
+      "include_dirs": [
+        "src",
+        "node_modules/tree-sitter/vendor/tree-sitter/lib/include",
+        "node_modules/tree-sitter/vendor/tree-sitter/lib/src"
+      ],
+      "sources": [
         "src/parser.c",
-        "src/scanner.cc"
-        # If your language uses an external scanner, add it here.
+        "src/scanner.cc",
+        "src/parallel-parse.cc",
+        "src/stream-parse.cc",
+        "src/chunked-document.cc",
+        "node_modules/tree-sitter/vendor/tree-sitter/lib/src/lib.c"
       ],
       "cflags_c": [
         "-std=c99",
+      ],
+      # Also linked into the node binding, which is a shared object
+      "cflags": [
+        "-fPIC"
+      ],
+      "direct_dependent_settings": {
+        "include_dirs": [
+          "src",
+          "node_modules/tree-sitter/vendor/tree-sitter/lib/include"
+        ]
+      }
+    },
+    {
+      "target_name": "parse_benchmark",
+      "type": "executable",
+      "dependencies": [
+        "tree_sitter_YOUR_LANGUAGE_NAME_native"
+      ],
+      "sources": [
+        "bench/parse-benchmark.cc"
+      ]
+    },
+    {
+      "target_name": "keyword_benchmark",
+      "type": "executable",
+      "include_dirs": [
+        "src"
+      ],
+      "sources": [
+        "bench/keyword-benchmark.cc"
+      ]
+    },
+    {
+      "target_name": "scanner_allocation_test",
+      "type": "executable",
+      "include_dirs": [
+        "src"
+      ],
+      "sources": [
+        "test/scanner-allocation-test.cc"
+      ]
+    },
+    {
+      "target_name": "parse_file",
+      "type": "executable",
+      "dependencies": [
+        "tree_sitter_YOUR_LANGUAGE_NAME_native"
+      ],
+      "sources": [
+        "cli/parse-file.cc"
       ]
     }
   ]
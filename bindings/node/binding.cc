@@ -1,15 +1,201 @@
 #include "tree_sitter/parser.h"
 #include <node.h>
 #include "nan.h"
+#include <string>
+#include <vector>
+#include "chunked-document.h"
+#include "parallel-parse.h"
+#include "stream-parse.h"
 
 using namespace v8;
 
-extern "C" TSLanguage * tree_sitter_YOUR_LANGUAGE_NAME();
+//`tree_sitter_YOUR_LANGUAGE_NAME()` is declared by the headers above
+extern "C" void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_compact_extras(bool compact);
 
 namespace {
 
 NAN_METHOD(New) {}
 
+NAN_METHOD(SetCompactExtras) {
+  tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_compact_extras(Nan::To<bool>(info[0]).FromJust());
+}
+
+void SetNumber(Local<Object> object, const char *key, double value) {
+  Nan::Set(object, Nan::New(key).ToLocalChecked(), Nan::New<Number>(value));
+}
+
+std::string ToUtf8(Local<Value> value) {
+  Nan::Utf8String utf8(value);
+  return std::string(*utf8, utf8.length());
+}
+
+/**
+ * `{ offset, length, type, hasError }`, `type` and `hasError` are null without a tree
+ */
+Local<Object> StatementSummary(YOUR_LANGUAGE_NAME::Statement const &statement, TSTree *tree) {
+  Local<Object> result = Nan::New<Object>();
+  SetNumber(result, "offset", static_cast<double>(statement.offset));
+  SetNumber(result, "length", static_cast<double>(statement.length));
+  if (tree == nullptr) {
+    Nan::Set(result, Nan::New("type").ToLocalChecked(), Nan::Null());
+    Nan::Set(result, Nan::New("hasError").ToLocalChecked(), Nan::Null());
+  } else {
+    TSNode root = ts_tree_root_node(tree);
+    Nan::Set(result, Nan::New("type").ToLocalChecked(), Nan::New(ts_node_type(root)).ToLocalChecked());
+    Nan::Set(result, Nan::New("hasError").ToLocalChecked(), Nan::New<Boolean>(ts_node_has_error(root)));
+  }
+  return result;
+}
+
+/**
+ * `{ type, startByte, endByte, hasError }`, or null for a null node
+ */
+Local<Value> DocumentNodeSummary(YOUR_LANGUAGE_NAME::DocumentNode const &node) {
+  if (ts_node_is_null(node.node)) {
+    return Nan::Null();
+  }
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, Nan::New("type").ToLocalChecked(), Nan::New(ts_node_type(node.node)).ToLocalChecked());
+  SetNumber(result, "startByte", static_cast<double>(node.startByte));
+  SetNumber(result, "endByte", static_cast<double>(node.endByte));
+  Nan::Set(result, Nan::New("hasError").ToLocalChecked(), Nan::New<Boolean>(ts_node_has_error(node.node)));
+  return result;
+}
+
+/**
+ * A `Buffer` of serialized scanner state; anything else goes back to the empty state
+ */
+NAN_METHOD(SetInitialState) {
+  if (node::Buffer::HasInstance(info[0])) {
+    tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(
+      node::Buffer::Data(info[0]),
+      static_cast<unsigned>(node::Buffer::Length(info[0]))
+    );
+  } else {
+    tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(nullptr, 0);
+  }
+}
+
+NAN_METHOD(GetInitialState) {
+  const char *state;
+  unsigned length = tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_get_initial_state(&state);
+  info.GetReturnValue().Set(Nan::CopyBuffer(state, length).ToLocalChecked());
+}
+
+/**
+ * `parseStatements(input, threadCount)`, returns a `StatementSummary()` per statement
+ */
+NAN_METHOD(ParseStatements) {
+  std::string input = ToUtf8(info[0]);
+  unsigned threadCount = Nan::To<uint32_t>(info[1]).FromMaybe(0);
+
+  std::vector<YOUR_LANGUAGE_NAME::Statement> statements;
+  std::vector<TSTree *> trees = YOUR_LANGUAGE_NAME::parseStatements(input.data(), input.size(), statements, threadCount);
+
+  Local<Array> result = Nan::New<Array>(static_cast<uint32_t>(statements.size()));
+  for (size_t i = 0; i < statements.size(); ++i) {
+    Nan::Set(result, static_cast<uint32_t>(i), StatementSummary(statements[i], trees[i]));
+    if (trees[i] != nullptr) {
+      ts_tree_delete(trees[i]);
+    }
+  }
+  info.GetReturnValue().Set(result);
+}
+
+/**
+ * `parseStream(input, callback)`, calls `callback` with a `StatementSummary()` per statement
+ * and returns the number of statements.
+ * Once `callback` throws, it is not called again.
+ */
+NAN_METHOD(ParseStream) {
+  std::string input = ToUtf8(info[0]);
+  if (!info[1]->IsFunction()) {
+    return Nan::ThrowTypeError("callback must be a function");
+  }
+  Local<Function> callback = info[1].As<Function>();
+
+  //Hands the input over in two reads, so a statement can span them
+  struct Payload {
+    std::string const *input;
+    size_t position;
+  } payload{ &input, 0 };
+  TSInput tsInput;
+  tsInput.payload = &payload;
+  tsInput.read = [] (void *payload, uint32_t, TSPoint, uint32_t *bytesRead) -> const char * {
+    auto self = static_cast<Payload *>(payload);
+    auto remaining = self->input->size() - self->position;
+    *bytesRead = static_cast<uint32_t>(self->position == 0 && remaining > 1 ? remaining / 2 : remaining);
+    auto result = self->input->data() + self->position;
+    self->position += *bytesRead;
+    return result;
+  };
+  tsInput.encoding = TSInputEncodingUTF8;
+
+  bool threw = false;
+  uint64_t statementCount = YOUR_LANGUAGE_NAME::parseStream(tsInput, [&] (
+    YOUR_LANGUAGE_NAME::Statement const &statement,
+    const char *,
+    TSTree *tree
+  ) {
+    if (threw) {
+      return;
+    }
+    Local<Value> argv[] = { StatementSummary(statement, tree) };
+    threw = Nan::Call(callback, Nan::GetCurrentContext()->Global(), 1, argv).IsEmpty();
+  });
+  if (!threw) {
+    info.GetReturnValue().Set(Nan::New<Number>(static_cast<double>(statementCount)));
+  }
+}
+
+/**
+ * `chunkedDocument(input, targetChunkLength)`, returns
+ * `{ chunks : [{ offset, length }], nodes : [{ type, startByte, endByte, hasError, depth }] }`
+ * with the nodes in `ChunkedDocument::forEachNode()` order.
+ */
+NAN_METHOD(ChunkedDocumentSummary) {
+  std::string input = ToUtf8(info[0]);
+  uint32_t targetChunkLength = Nan::To<uint32_t>(info[1]).FromMaybe(0);
+  YOUR_LANGUAGE_NAME::ChunkedDocument document(input.data(), input.size(), targetChunkLength > 0 ? targetChunkLength : 256 * 1024);
+
+  auto const &documentChunks = document.chunks();
+  Local<Array> chunks = Nan::New<Array>(static_cast<uint32_t>(documentChunks.size()));
+  for (size_t i = 0; i < documentChunks.size(); ++i) {
+    Local<Object> chunk = Nan::New<Object>();
+    SetNumber(chunk, "offset", static_cast<double>(documentChunks[i].offset));
+    SetNumber(chunk, "length", static_cast<double>(documentChunks[i].length));
+    Nan::Set(chunks, static_cast<uint32_t>(i), chunk);
+  }
+
+  Local<Array> nodes = Nan::New<Array>();
+  uint32_t nodeCount = 0;
+  document.forEachNode([&] (YOUR_LANGUAGE_NAME::DocumentNode const &node, unsigned depth) {
+    Local<Object> summary = DocumentNodeSummary(node).As<Object>();
+    SetNumber(summary, "depth", depth);
+    Nan::Set(nodes, nodeCount++, summary);
+    return true;
+  });
+
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, Nan::New("chunks").ToLocalChecked(), chunks);
+  Nan::Set(result, Nan::New("nodes").ToLocalChecked(), nodes);
+  info.GetReturnValue().Set(result);
+}
+
+/**
+ * `chunkedDocumentDescendant(input, targetChunkLength, startByte, endByte)`,
+ * returns `{ type, startByte, endByte, hasError }`, or null for an empty document
+ */
+NAN_METHOD(ChunkedDocumentDescendant) {
+  std::string input = ToUtf8(info[0]);
+  uint32_t targetChunkLength = Nan::To<uint32_t>(info[1]).FromMaybe(0);
+  //JavaScript strings are far shorter than 4 GiB
+  uint32_t startByte = Nan::To<uint32_t>(info[2]).FromMaybe(0);
+  uint32_t endByte = Nan::To<uint32_t>(info[3]).FromMaybe(0);
+  YOUR_LANGUAGE_NAME::ChunkedDocument document(input.data(), input.size(), targetChunkLength > 0 ? targetChunkLength : 256 * 1024);
+  info.GetReturnValue().Set(DocumentNodeSummary(document.descendantForByteRange(startByte, endByte)));
+}
+
 void Init(Local<Object> exports, Local<Object> module) {
   Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
   tpl->SetClassName(Nan::New("Language").ToLocalChecked());
@@ -17,9 +203,16 @@ void Init(Local<Object> exports, Local<Object> module) {
 
   Local<Function> constructor = Nan::GetFunction(tpl).ToLocalChecked();
   Local<Object> instance = constructor->NewInstance(Nan::GetCurrentContext()).ToLocalChecked();
-  Nan::SetInternalFieldPointer(instance, 0, tree_sitter_YOUR_LANGUAGE_NAME());
+  Nan::SetInternalFieldPointer(instance, 0, const_cast<TSLanguage *>(tree_sitter_YOUR_LANGUAGE_NAME()));
 
   Nan::Set(instance, Nan::New("name").ToLocalChecked(), Nan::New("YOUR_LANGUAGE_NAME").ToLocalChecked());
+  Nan::SetMethod(instance, "setCompactExtras", SetCompactExtras);
+  Nan::SetMethod(instance, "setInitialState", SetInitialState);
+  Nan::SetMethod(instance, "getInitialState", GetInitialState);
+  Nan::SetMethod(instance, "parseStatements", ParseStatements);
+  Nan::SetMethod(instance, "parseStream", ParseStream);
+  Nan::SetMethod(instance, "chunkedDocument", ChunkedDocumentSummary);
+  Nan::SetMethod(instance, "chunkedDocumentDescendant", ChunkedDocumentDescendant);
   Nan::Set(module, Nan::New("exports").ToLocalChecked(), instance);
 }
 
@@ -0,0 +1,288 @@
+/**
+ * Parses a SQL file without Node, and reports how it went.
+ *
+ * The file is memory-mapped, split into statements, and every statement is parsed
+ * through a `TSInput` that reads straight from the mapping.
+ * Statements start under the `DELIMITER` active where they begin,
+ * so files larger than tree-sitter's 4 GiB limit are fine as long as no single statement is.
+ *
+ * Usage: parse_file [--quiet] FILE
+ */
+#include <tree_sitter/api.h>
+#include <tree_sitter/parser.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "tokenizer.h"
+
+extern "C" {
+    const TSLanguage *tree_sitter_YOUR_LANGUAGE_NAME(void);
+    void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(const char *buffer, unsigned length);
+}
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Only one in this many `scan()` calls is timed.
+     * A scan is often shorter than the two clock reads around it,
+     * so timing every call would mostly measure the clock.
+     */
+    constexpr uint64_t scanSampleInterval = 64;
+
+    /**
+     * Time spent in the sampled `scan()` calls, see `timedScan()`
+     */
+    Clock::duration sampledScannerTime = Clock::duration::zero();
+    uint64_t sampledScanCalls = 0;
+    uint64_t scanCalls = 0;
+    bool (*originalScan)(void *, TSLexer *, const bool *) = nullptr;
+
+    bool timedScan (void *payload, TSLexer *lexer, const bool *validSymbols) {
+        if (scanCalls++ % scanSampleInterval != 0) {
+            return originalScan(payload, lexer, validSymbols);
+        }
+        auto start = Clock::now();
+        auto result = originalScan(payload, lexer, validSymbols);
+        sampledScannerTime += Clock::now() - start;
+        ++sampledScanCalls;
+        return result;
+    }
+
+    /**
+     * A copy of the language whose external scanner is timed.
+     */
+    TSLanguage makeTimedLanguage () {
+        TSLanguage result = *tree_sitter_YOUR_LANGUAGE_NAME();
+        originalScan = result.external_scanner.scan;
+        result.external_scanner.scan = timedScan;
+        return result;
+    }
+
+    struct MappedFile {
+        const char *data = nullptr;
+        size_t length = 0;
+
+        bool open (const char *path) {
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat info;
+            if (fstat(fd, &info) != 0) {
+                close(fd);
+                return false;
+            }
+            length = static_cast<size_t>(info.st_size);
+            if (length > 0) {
+                void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED) {
+                    close(fd);
+                    return false;
+                }
+                madvise(mapping, length, MADV_SEQUENTIAL);
+                data = static_cast<const char *>(mapping);
+            }
+            close(fd);
+            return true;
+        }
+
+        ~MappedFile () {
+            if (data != nullptr) {
+                munmap(const_cast<char *>(data), length);
+            }
+        }
+    };
+
+    /**
+     * Hands tree-sitter the statement's bytes in place, in one piece.
+     */
+    struct StatementInput {
+        const char *data;
+        uint32_t length;
+
+        static const char *read (void *payload, uint32_t byteIndex, TSPoint, uint32_t *bytesRead) {
+            auto self = static_cast<StatementInput *>(payload);
+            if (byteIndex >= self->length) {
+                *bytesRead = 0;
+                return "";
+            }
+            *bytesRead = self->length - byteIndex;
+            return self->data + byteIndex;
+        }
+    };
+
+    /**
+     * Counts `ERROR` and `MISSING` nodes, only descending into subtrees that have one.
+     */
+    uint64_t countErrors (TSNode root) {
+        if (!ts_node_has_error(root)) {
+            return 0;
+        }
+
+        uint64_t result = 0;
+        TSTreeCursor cursor = ts_tree_cursor_new(root);
+        while (true) {
+            TSNode node = ts_tree_cursor_current_node(&cursor);
+            if (ts_node_symbol(node) == ts_builtin_sym_error || ts_node_is_missing(node)) {
+                ++result;
+            }
+            if (ts_node_has_error(node) && ts_tree_cursor_goto_first_child(&cursor)) {
+                continue;
+            }
+            while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+                if (!ts_tree_cursor_goto_parent(&cursor)) {
+                    ts_tree_cursor_delete(&cursor);
+                    return result;
+                }
+            }
+        }
+    }
+
+    /**
+     * In MiB
+     */
+    double peakResidentSetSize () {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+        return usage.ru_maxrss / 1024.0;
+#endif
+    }
+
+    double seconds (Clock::duration duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+
+    /**
+     * Time spent in the external scanner, extrapolated from the sampled calls
+     */
+    double estimatedScannerSeconds () {
+        if (sampledScanCalls == 0) {
+            return 0;
+        }
+        return seconds(sampledScannerTime) * scanCalls / sampledScanCalls;
+    }
+}
+
+int main (int argc, char **argv) {
+    const char *path = nullptr;
+    bool quiet = false;
+
+    for (int i=1; i<argc; ++i) {
+        if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (path == nullptr && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (path == nullptr) {
+        fprintf(stderr, "Usage: %s [--quiet] FILE\n", argv[0]);
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.open(path)) {
+        fprintf(stderr, "Cannot read %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    auto language = makeTimedLanguage();
+    TSParser *parser = ts_parser_new();
+    ts_parser_set_language(parser, &language);
+
+    uint64_t statementCount = 0;
+    uint64_t statementsWithErrors = 0;
+    uint64_t errorCount = 0;
+    uint64_t tooLongCount = 0;
+    auto parseTime = Clock::duration::zero();
+    auto countErrorsTime = Clock::duration::zero();
+
+    auto start = Clock::now();
+    YOUR_LANGUAGE_NAME::splitStatements(
+        file.data,
+        file.length,
+        [&] (YOUR_LANGUAGE_NAME::Statement const &statement) {
+            ++statementCount;
+            if (statement.length > UINT32_MAX) {
+                ++tooLongCount;
+                return;
+            }
+
+            StatementInput statementInput{
+                file.data + statement.offset,
+                static_cast<uint32_t>(statement.length)
+            };
+            TSInput input;
+            input.payload = &statementInput;
+            input.read = StatementInput::read;
+            input.encoding = TSInputEncodingUTF8;
+
+            tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(
+                statement.scannerState.data(),
+                static_cast<unsigned>(statement.scannerState.size())
+            );
+            auto parseStart = Clock::now();
+            TSTree *tree = ts_parser_parse(parser, nullptr, input);
+            parseTime += Clock::now() - parseStart;
+
+            auto countErrorsStart = Clock::now();
+            auto errors = countErrors(ts_tree_root_node(tree));
+            countErrorsTime += Clock::now() - countErrorsStart;
+            if (errors > 0) {
+                ++statementsWithErrors;
+                errorCount += errors;
+                if (!quiet) {
+                    fprintf(
+                        stderr,
+                        "%s: %llu error(s) in statement at byte %llu\n",
+                        path,
+                        static_cast<unsigned long long>(errors),
+                        static_cast<unsigned long long>(statement.offset)
+                    );
+                }
+            }
+            ts_tree_delete(tree);
+        }
+    );
+    auto totalTime = Clock::now() - start;
+
+    ts_parser_delete(parser);
+
+    auto megabytes = static_cast<double>(file.length) / (1024 * 1024);
+    printf("file:                 %s\n", path);
+    printf("bytes:                %llu\n", static_cast<unsigned long long>(file.length));
+    printf("statements:           %llu\n", static_cast<unsigned long long>(statementCount));
+    printf("statements w/ errors: %llu\n", static_cast<unsigned long long>(statementsWithErrors));
+    printf("errors:               %llu\n", static_cast<unsigned long long>(errorCount));
+    if (tooLongCount > 0) {
+        printf("skipped (> 4 GiB):    %llu\n", static_cast<unsigned long long>(tooLongCount));
+    }
+    auto scannerSeconds = estimatedScannerSeconds();
+    printf("total seconds:        %.3f\n", seconds(totalTime));
+    printf("  splitting:          %.3f\n", seconds(totalTime - parseTime - countErrorsTime));
+    printf(
+        "  scanner:            %.3f (%llu scans, 1 in %llu timed)\n",
+        scannerSeconds,
+        static_cast<unsigned long long>(scanCalls),
+        static_cast<unsigned long long>(scanSampleInterval)
+    );
+    printf("  parser:             %.3f\n", seconds(parseTime) - scannerSeconds);
+    printf("  counting errors:    %.3f\n", seconds(countErrorsTime));
+    printf("MB/s:                 %.2f\n", seconds(totalTime) > 0 ? megabytes / seconds(totalTime) : 0.0);
+    printf("peak RSS MiB:         %.1f\n", peakResidentSetSize());
+
+    return errorCount > 0 || tooLongCount > 0 ? 2 : 0;
+}
@@ -21,6 +21,7 @@ module.exports = grammar({
         $.Statement,
         $.Schema,
         $.CharSet,
+        $.Literal,
     ],
     supertypes: $ => [
         $.Statement,
@@ -36,6 +37,7 @@ module.exports = grammar({
             //TODO
             $.BinLogStatement,
             $.CreateSchemaStatement,
+            $.DoStatement,
         ),
 
         BinLogStatement: $ => seq(
@@ -99,6 +101,28 @@ module.exports = grammar({
             field("existsToken", $.EXISTS),
         ),
 
+        /**
+         * Evaluates expressions and discards their results.
+         * Only literals, for now.
+         */
+        DoStatement: $ => seq(
+            field("doToken", $.DO),
+            field("item", $.Literal),
+            repeat(seq(
+                field("commaToken", $.Comma),
+                field("item", $.Literal),
+            )),
+        ),
+
+        Literal: $ => choice(
+            $.StringLiteral,
+            $.HexLiteral,
+            $.BitLiteral,
+            $.IntegerLiteral,
+            $.DecimalLiteral,
+            $.RealLiteral,
+        ),
+
         LeadingStatement: $ => seq(
             field("statement", $.Statement),
             choice(
@@ -1,11 +1,19 @@
 const Parser = require('tree-sitter');
 const language = require(".");
 
-function parse (input) {
+/**
+ * `options.compactExtras` leaves whitespace and line breaks out of the tree
+ */
+function parse (input, options = {}) {
     const parser = new Parser();
     parser.setLanguage(language);
 
-    return parser.parse(input);
+    language.setCompactExtras(Boolean(options.compactExtras));
+    try {
+        return parser.parse(input);
+    } finally {
+        language.setCompactExtras(false);
+    }
 }
 module.exports = {
     parse,
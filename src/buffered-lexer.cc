@@ -1,60 +1,548 @@
 #ifndef BUFFERED_LEXER_CC
 #define BUFFERED_LEXER_CC
 #include <tree_sitter/parser.h>
-#include <deque>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include "./character-code.cc"
+#include "./utf8.cc"
+
+/**
+ * For slow paths that would otherwise be inlined into hot callers, and make them too big to inline
+ */
+#if defined(_MSC_VER)
+#define SCANNER_NOINLINE __declspec(noinline)
+#else
+#define SCANNER_NOINLINE __attribute__((noinline))
+#endif
 
 namespace {
 
+    /**
+     * A `TSLexer` over a contiguous buffer, for scanning without tree-sitter.
+     *
+     * `lexer` must stay the first member, the callbacks cast back to `MemoryLexer`.
+     * Positions are byte offsets. Characters are decoded from UTF-8 like tree-sitter does,
+     * and a NUL byte reads as end of input like it does in tree-sitter.
+     */
+    struct MemoryLexer {
+        TSLexer lexer;
+        const char *data = nullptr;
+        size_t length = 0;
+        size_t position = 0;
+        /**
+         * Start of the current token; moved forward by skipped characters
+         */
+        size_t start = 0;
+        /**
+         * End of the current token, as set by `mark_end`
+         */
+        size_t end = 0;
+        /**
+         * Furthest position looked at since `seek()`
+         */
+        size_t furthest = 0;
+        /**
+         * True if a character looked at since `seek()` was cut short by the end of `data`.
+         * If more data may follow, the scan should be retried with it.
+         */
+        bool sawIncompleteCharacter = false;
+        /**
+         * Every byte from `asciiStart` up to `asciiEnd` is ASCII,
+         * and `asciiEnd` is `length` or the index of a non-ASCII byte.
+         * `position` is always in this range, so characters before `asciiEnd`
+         * are found without decoding anything.
+         */
+        size_t asciiStart = 0;
+        size_t asciiEnd = 0;
+        /**
+         * Past `asciiEnd`, the character `cursorOffset` characters after `position` starts at `cursorIndex`.
+         * Lets `peek()` at increasing offsets pick up where the last one left off.
+         */
+        size_t cursorOffset = 0;
+        size_t cursorIndex = 0;
+
+        MemoryLexer () {
+            lexer.lookahead = 0;
+            lexer.result_symbol = 0;
+            lexer.advance = advanceCallback;
+            lexer.mark_end = markEndCallback;
+            lexer.get_column = getColumnCallback;
+            lexer.is_at_included_range_start = isAtIncludedRangeStartCallback;
+            lexer.eof = eofCallback;
+        }
+
+        MemoryLexer (MemoryLexer const &) = delete;
+        MemoryLexer &operator= (MemoryLexer const &) = delete;
+
+        void reset (const char *data, size_t length, size_t position) {
+            this->data = data;
+            this->length = length;
+            findAsciiEnd(position);
+            seek(position);
+        }
+
+        void seek (size_t position) {
+            this->position = position;
+            start = position;
+            end = position;
+            furthest = position;
+            sawIncompleteCharacter = false;
+            if (position < asciiStart || position > asciiEnd) {
+                findAsciiEnd(position);
+            }
+            resetCursor();
+            syncLookahead();
+        }
+
+        void findAsciiEnd (size_t from) {
+            auto index = from;
+            //Eight bytes at a time, until one of them has its high bit set
+            while (index + sizeof(uint64_t) <= length) {
+                uint64_t word;
+                memcpy(&word, data + index, sizeof(word));
+                if ((word & 0x8080808080808080ULL) != 0) {
+                    break;
+                }
+                index += sizeof(word);
+            }
+            while (index < length && static_cast<unsigned char>(data[index]) < 0x80) {
+                ++index;
+            }
+            asciiStart = from;
+            asciiEnd = index;
+        }
+
+        void resetCursor () {
+            cursorOffset = asciiEnd - position;
+            cursorIndex = asciiEnd;
+        }
+
+        /**
+         * Decodes the character at `index`, which must be less than `length`.
+         * Returns its length in bytes.
+         */
+        size_t decodeAt (size_t index, int32_t &codePoint) {
+            auto lead = static_cast<unsigned char>(data[index]);
+            if (lead < 0x80) {
+                codePoint = lead;
+                return 1;
+            }
+            if (index + utf8SequenceLength(lead) > length) {
+                sawIncompleteCharacter = true;
+            }
+            return decodeUtf8(data + index, length - index, codePoint);
+        }
+
+        /**
+         * Byte index of the character `offset` characters after `position`,
+         * or `length` if the input ends before it
+         */
+        size_t indexOf (size_t offset) {
+            if (position + offset <= asciiEnd) {
+                return position + offset;
+            }
+            if (offset < cursorOffset) {
+                resetCursor();
+            }
+            while (cursorOffset < offset && cursorIndex < length) {
+                int32_t codePoint;
+                cursorIndex += decodeAt(cursorIndex, codePoint);
+                ++cursorOffset;
+            }
+            return cursorOffset == offset ? cursorIndex : length;
+        }
+
+        void lookAt (size_t index) {
+            if (index >= length) {
+                furthest = length;
+            } else if (index > furthest) {
+                furthest = index;
+            }
+        }
+
+        int32_t peek (size_t offset) {
+            auto index = position + offset;
+            if (index < asciiEnd) {
+                if (index > furthest) {
+                    furthest = index;
+                }
+                return static_cast<unsigned char>(data[index]);
+            }
+            return peekDecoded(offset);
+        }
+
+        SCANNER_NOINLINE int32_t peekDecoded (size_t offset) {
+            auto index = indexOf(offset);
+            lookAt(index);
+            if (index >= length) {
+                return 0;
+            }
+            int32_t codePoint;
+            decodeAt(index, codePoint);
+            return codePoint;
+        }
+
+        /**
+         * Number of characters from `offset` on that have one of the classes in `flags`.
+         * Looks at the same characters as calling `peek()` on each would.
+         */
+        size_t countWhile (size_t offset, uint8_t flags) {
+            auto index = position + offset;
+            if (index >= asciiEnd) {
+                return countWhileDecoded(offset, flags);
+            }
+            auto asciiIndex = index;
+            while (asciiIndex < asciiEnd && hasCharacterClass(static_cast<unsigned char>(data[asciiIndex]), flags)) {
+                ++asciiIndex;
+            }
+            auto count = asciiIndex - index;
+            if (asciiIndex < asciiEnd) {
+                lookAt(asciiIndex);
+                return count;
+            }
+            return count + countWhileDecoded(offset + count, flags);
+        }
+
+        /**
+         * Number of characters from `offset` up to the next line break or the end of input
+         */
+        size_t countUntilLineBreak (size_t offset) {
+            auto index = position + offset;
+            if (index >= asciiEnd) {
+                return countWhileDecoded(offset, CharacterClass::LineBreak, false);
+            }
+            auto lineBreak = findLineBreak(index);
+            if (lineBreak < asciiEnd) {
+                lookAt(lineBreak);
+                return lineBreak - index;
+            }
+            auto count = asciiEnd - index;
+            return count + countWhileDecoded(offset + count, CharacterClass::LineBreak, false);
+        }
+
+        /**
+         * Index of the first `\r`, `\n` or NUL byte from `index` on,
+         * or `asciiEnd` if there is none before it
+         */
+        size_t findLineBreak (size_t index) {
+            const uint64_t ones = 0x0101010101010101ULL;
+            const uint64_t highBits = ones * 0x80;
+            //Eight bytes at a time. Every byte is ASCII here, so subtracting one from a byte
+            //only sets its high bit if the byte was zero (or a byte below it was)
+            while (index + sizeof(uint64_t) <= asciiEnd) {
+                uint64_t word;
+                memcpy(&word, data + index, sizeof(word));
+                auto lineFeeds = word ^ (ones * CharacterCodes::lineFeed);
+                auto carriageReturns = word ^ (ones * CharacterCodes::carriageReturn);
+                if ((((word - ones) | (lineFeeds - ones) | (carriageReturns - ones)) & highBits) != 0) {
+                    break;
+                }
+                index += sizeof(word);
+            }
+            while (index < asciiEnd) {
+                auto ch = data[index];
+                if (ch == CharacterCodes::lineFeed || ch == CharacterCodes::carriageReturn || ch == 0) {
+                    break;
+                }
+                ++index;
+            }
+            return index;
+        }
+
+        /**
+         * Like `countWhile()` past `asciiEnd`.
+         * If `hasClass` is false, counts characters with none of the classes in `flags` instead,
+         * up to the end of input.
+         */
+        SCANNER_NOINLINE size_t countWhileDecoded (size_t offset, uint8_t flags, bool hasClass = true) {
+            auto index = indexOf(offset);
+            size_t count = 0;
+            while (index < length) {
+                int32_t codePoint;
+                auto characterLength = decodeAt(index, codePoint);
+                if (codePoint == 0 || hasCharacterClass(codePoint, flags) != hasClass) {
+                    break;
+                }
+                index += characterLength;
+                ++count;
+            }
+            lookAt(index);
+            cursorOffset = offset + count;
+            cursorIndex = index;
+            return count;
+        }
+
+        void advanceN (size_t n) {
+            if (position + n <= asciiEnd) {
+                position += n;
+                cursorOffset -= n;
+            } else {
+                position = indexOf(n);
+                findAsciiEnd(position);
+                resetCursor();
+            }
+            if (position > furthest) {
+                furthest = position;
+            }
+            syncLookahead();
+        }
+
+        /**
+         * A `TSLexer` driven through `BufferedLexer` has really advanced past everything
+         * that was peeked, so that is where `mark_end` lands. Do the same here.
+         */
+        void markEnd () {
+            end = furthest;
+        }
+
+        void syncLookahead () {
+            if (position < asciiEnd) {
+                lexer.lookahead = static_cast<unsigned char>(data[position]);
+            } else if (position >= length) {
+                lexer.lookahead = 0;
+            } else {
+                decodeAt(position, lexer.lookahead);
+            }
+        }
+
+        static MemoryLexer *from (const TSLexer *lexer) {
+            return reinterpret_cast<MemoryLexer *>(const_cast<TSLexer *>(lexer));
+        }
+
+        static void advanceCallback (TSLexer *lexer, bool skip) {
+            auto self = from(lexer);
+            self->advanceN(1);
+            if (skip) {
+                self->start = self->position;
+            }
+        }
+
+        static void markEndCallback (TSLexer *lexer) {
+            from(lexer)->markEnd();
+        }
+
+        static uint32_t getColumnCallback (TSLexer *lexer) {
+            auto self = from(lexer);
+            uint32_t column = 0;
+            while (column < self->position && self->data[self->position - column - 1] != '\n') {
+                ++column;
+            }
+            return column;
+        }
+
+        static bool isAtIncludedRangeStartCallback (const TSLexer *) {
+            return false;
+        }
+
+        static bool eofCallback (const TSLexer *lexer) {
+            auto self = from(lexer);
+            return self->position >= self->length;
+        }
+    };
+
+    /**
+     * Lookahead is kept in a ring buffer of code points, as `TSLexer::lookahead` gives them.
+     * Short lookahead fits in `inlineBuffer`.
+     *
+     * Long tokens that are never backtracked over (strings, comments, identifiers,
+     * whitespace, runs of unknown characters, `DELIMITER` text) are committed while they are scanned,
+     * so they stay within `inlineBuffer` too.
+     * The exception is a run of digits at the start of a number, which is held until
+     * it is known whether it is a number or an identifier.
+     * That spills to `heapBuffer`, which is kept across calls to `setLexer()`.
+     */
     struct BufferedLexer {
-        std::deque<char> buffer;
+        static const size_t inlineCapacity = 64;
+
+        int32_t inlineBuffer[inlineCapacity];
+        std::unique_ptr<int32_t[]> heapBuffer;
+        int32_t *buffer = inlineBuffer;
+        /**
+         * Always a power of two
+         */
+        size_t capacity = inlineCapacity;
+        size_t head = 0;
+        size_t count = 0;
         TSLexer *lexer;
+        /**
+         * If set, characters are read straight from memory
+         * and the ring buffer is not used.
+         */
+        MemoryLexer *memoryLexer = nullptr;
+#ifdef SCANNER_STATS
+        /**
+         * Characters advanced past since `setLexer()`, the token length as of the last `markEnd()`,
+         * and the deepest the ring buffer got
+         */
+        size_t advancedCount = 0;
+        size_t markedCount = 0;
+        size_t maxCount = 0;
+#endif
+
+        BufferedLexer () {
+        }
+
+        BufferedLexer (BufferedLexer const &) = delete;
+        BufferedLexer &operator= (BufferedLexer const &) = delete;
 
         void setLexer (TSLexer *lexer) {
-            this->buffer.clear();
+            this->head = 0;
+            this->count = 0;
+#ifdef SCANNER_STATS
+            this->advancedCount = 0;
+            this->markedCount = 0;
+            this->maxCount = 0;
+#endif
             this->lexer = lexer;
+            this->memoryLexer = nullptr;
+            markEnd();
+        }
+
+        void setMemoryLexer (MemoryLexer *memoryLexer) {
+            this->head = 0;
+            this->count = 0;
+            this->lexer = &memoryLexer->lexer;
+            this->memoryLexer = memoryLexer;
             markEnd();
         }
 
-        char peek (int offset) {
-            while (static_cast<size_t>(offset) > buffer.size()) {
-                buffer.push_back(lexer->lookahead);
+        void grow () {
+            auto newCapacity = capacity * 2;
+            std::unique_ptr<int32_t[]> newBuffer(new int32_t[newCapacity]);
+            for (size_t i=0; i<count; ++i) {
+                newBuffer[i] = buffer[(head + i) & (capacity - 1)];
+            }
+            heapBuffer = std::move(newBuffer);
+            buffer = heapBuffer.get();
+            capacity = newCapacity;
+            head = 0;
+        }
+
+        void pushBack (int32_t ch) {
+            if (count == capacity) {
+                grow();
+            }
+            buffer[(head + count) & (capacity - 1)] = ch;
+            ++count;
+#ifdef SCANNER_STATS
+            if (count > maxCount) {
+                maxCount = count;
+            }
+#endif
+        }
+
+        int32_t peek (int offset) {
+            if (memoryLexer != nullptr) {
+                return memoryLexer->peek(offset);
+            }
+
+            while (static_cast<size_t>(offset) > count) {
+                pushBack(lexer->lookahead);
                 lexer->advance(lexer, false);
             }
 
-            if (static_cast<size_t>(offset) == buffer.size()) {
+            if (static_cast<size_t>(offset) == count) {
                 return lexer->lookahead;
             }
 
-            return buffer[offset];
+            return buffer[(head + offset) & (capacity - 1)];
         }
 
         bool isEof (int offset) {
             return peek(offset) == 0;
         }
 
-        char advance () {
-            if (buffer.size() == 0) {
+        /**
+         * Number of characters from `offset` on that have one of the classes in `flags`
+         */
+        int countWhile (int offset, uint8_t flags) {
+            if (memoryLexer != nullptr) {
+                return static_cast<int>(memoryLexer->countWhile(offset, flags));
+            }
+
+            auto end = offset;
+            while (hasCharacterClass(peek(end), flags)) {
+                ++end;
+            }
+            return end - offset;
+        }
+
+        int32_t advance () {
+            if (memoryLexer != nullptr) {
+                auto result = memoryLexer->peek(0);
+                memoryLexer->advanceN(1);
+                return result;
+            }
+
+#ifdef SCANNER_STATS
+            ++advancedCount;
+#endif
+            if (count == 0) {
                 auto result = lexer->lookahead;
                 lexer->advance(lexer, false);
                 return result;
             }
 
-            auto result = buffer.front();
-            buffer.pop_front();
+            auto result = buffer[head];
+            head = (head + 1) & (capacity - 1);
+            --count;
             return result;
         }
 
         void advanceN (int n) {
-            for (int i=0; i<n; ++i) {
-                advance();
+            if (memoryLexer != nullptr) {
+                memoryLexer->advanceN(n);
+                return;
+            }
+
+#ifdef SCANNER_STATS
+            advancedCount += n;
+#endif
+            auto buffered = static_cast<size_t>(n) < count ? static_cast<size_t>(n) : count;
+            head = (head + buffered) & (capacity - 1);
+            count -= buffered;
+
+            for (size_t i=buffered; i<static_cast<size_t>(n); ++i) {
+                lexer->advance(lexer, false);
             }
         }
 
         void markEnd () {
+            if (memoryLexer != nullptr) {
+                memoryLexer->markEnd();
+                return;
+            }
+#ifdef SCANNER_STATS
+            markedCount = advancedCount + count;
+#endif
             lexer->mark_end(lexer);
         }
+
+#ifdef SCANNER_STATS
+        size_t tokenLength () const {
+            if (memoryLexer != nullptr) {
+                return memoryLexer->end - memoryLexer->start;
+            }
+            return markedCount;
+        }
+
+        size_t lookaheadDepth () const {
+            if (memoryLexer != nullptr) {
+                return memoryLexer->furthest - memoryLexer->start;
+            }
+            return maxCount;
+        }
+#endif
     };
     struct TmpLexer {
+        /**
+         * How far `commitIfFar()` lets a scan get ahead before committing.
+         * Small enough that a committing scan stays inside `BufferedLexer::inlineBuffer`.
+         */
+        static const int commitDistance = 32;
+
         BufferedLexer &lexer;
         int index = 0;
 
@@ -64,7 +552,7 @@ namespace {
         TmpLexer (TmpLexer &lexer) : lexer(lexer.lexer), index(lexer.index) {
         }
 
-        char peek (int offset) {
+        int32_t peek (int offset) {
             return lexer.peek(index+offset);
         }
 
@@ -72,17 +560,87 @@ namespace {
             return lexer.isEof(index+offset);
         }
 
-        char advance () {
+        int32_t advance () {
             auto result = peek(0);
             ++index;
             return result;
         }
 
+        /**
+         * Advances past every character that has one of the classes in `flags`.
+         * Returns how many there were.
+         */
+        int advanceWhile (uint8_t flags) {
+            auto count = lexer.countWhile(index, flags);
+            index += count;
+            return count;
+        }
+
+        /**
+         * Same as `advanceWhile()`, but through `TSLexer`, commits as it goes (see `commit()`).
+         * Only for runs that are never backtracked over.
+         */
+        int advanceWhileCommitting (uint8_t flags) {
+            if (lexer.memoryLexer != nullptr) {
+                return advanceWhile(flags);
+            }
+
+            int count = 0;
+            while (hasCharacterClass(peek(0), flags)) {
+                commitIfFar();
+                advance();
+                ++count;
+            }
+            return count;
+        }
+
+        /**
+         * Advances to the next line break, or the end of input.
+         * Returns how many characters that was.
+         *
+         * Through `TSLexer`, this commits as it goes (see `commit()`),
+         * so a long line does not have to be buffered.
+         */
+        int advanceUntilLineBreak () {
+            if (lexer.memoryLexer != nullptr) {
+                auto count = static_cast<int>(lexer.memoryLexer->countUntilLineBreak(index));
+                index += count;
+                return count;
+            }
+
+            int count = 0;
+            while (!isEof(0) && !isLineBreak(peek(0))) {
+                commitIfFar();
+                advance();
+                ++count;
+            }
+            return count;
+        }
+
         void markEnd () {
             lexer.advanceN(index);
             lexer.markEnd();
             index = 0;
         }
+
+        /**
+         * Consumes everything before the current position, without marking the end of the token.
+         * Only for scans that can no longer backtrack past this point;
+         * it keeps `BufferedLexer` from holding on to the whole token.
+         *
+         * Other `TmpLexer`s on the same `BufferedLexer` keep their old `index`,
+         * so they must be synced (`lexer.index = tmp.index`) before they are used again.
+         */
+        void commit () {
+            lexer.advanceN(index);
+            index = 0;
+        }
+
+        void commitIfFar () {
+            if (index >= commitDistance) {
+                commit();
+            }
+        }
     };
 }
 #endif
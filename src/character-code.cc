@@ -1,5 +1,6 @@
 #ifndef CHARACTER_CODE_CC
 #define CHARACTER_CODE_CC
+#include <cstdint>
 #include <string>
 
 namespace {
@@ -142,44 +143,168 @@ namespace {
         verticalTab = 0x0B,           // \v
     };
 
-    bool isUnquotedIdentifierCharacter (char ch) {
-        return (
-            (ch >= CharacterCodes::a && ch <= CharacterCodes::z) ||
-            (ch >= CharacterCodes::A && ch <= CharacterCodes::Z) ||
-            (ch >= CharacterCodes::_0 && ch <= CharacterCodes::_9) ||
-            ch == CharacterCodes::_ ||
-            ch == CharacterCodes::$ ||
-            (ch >= 0x80 && ch <= 0xFFFF)
-        );
+    /**
+     * Bit flags, see `characterClassTable`
+     */
+    struct CharacterClass {
+        enum Flag : uint8_t {
+            UnquotedIdentifier = 1 << 0,
+            Digit = 1 << 1,
+            WhiteSpace = 1 << 2,
+            LineBreak = 1 << 3,
+            Quote = 1 << 4,
+            OperatorStart = 1 << 5,
+            HexDigit = 1 << 6,
+            BitDigit = 1 << 7,
+        };
+    };
+
+    struct CharacterClassTable {
+        uint8_t flags[256];
+    };
+
+    constexpr void addCharacterClass (CharacterClassTable &table, unsigned char ch, uint8_t flags) {
+        table.flags[ch] |= flags;
     }
 
-    bool isWhiteSpace (char ch) {
-        return (
-            ch == CharacterCodes::space ||
-            ch == CharacterCodes::tab ||
-            ch == CharacterCodes::verticalTab ||
-            ch == CharacterCodes::formFeed
-        );
+    constexpr void addCharacterClass (CharacterClassTable &table, unsigned char first, unsigned char last, uint8_t flags) {
+        for (unsigned ch=first; ch<=last; ++ch) {
+            table.flags[ch] |= flags;
+        }
     }
 
-    bool isLineBreak (char ch) {
-        return (
-            ch == CharacterCodes::lineFeed ||
-            ch == CharacterCodes::carriageReturn
+    constexpr CharacterClassTable makeCharacterClassTable () {
+        CharacterClassTable table = {};
+
+        addCharacterClass(table, CharacterCodes::a, CharacterCodes::z, CharacterClass::UnquotedIdentifier);
+        addCharacterClass(table, CharacterCodes::A, CharacterCodes::Z, CharacterClass::UnquotedIdentifier);
+        addCharacterClass(
+            table,
+            CharacterCodes::_0,
+            CharacterCodes::_9,
+            CharacterClass::UnquotedIdentifier | CharacterClass::Digit | CharacterClass::HexDigit
         );
+        addCharacterClass(table, CharacterCodes::_, CharacterClass::UnquotedIdentifier);
+        addCharacterClass(table, CharacterCodes::$, CharacterClass::UnquotedIdentifier);
+        //https://dev.mysql.com/doc/refman/5.7/en/identifiers.html
+        //U+0080 .. U+FFFF, except the whitespace below
+        addCharacterClass(table, 0x80, 0xFF, CharacterClass::UnquotedIdentifier);
+
+        addCharacterClass(table, CharacterCodes::a, CharacterCodes::f, CharacterClass::HexDigit);
+        addCharacterClass(table, CharacterCodes::A, CharacterCodes::F, CharacterClass::HexDigit);
+        addCharacterClass(table, CharacterCodes::_0, CharacterClass::BitDigit);
+        addCharacterClass(table, CharacterCodes::_1, CharacterClass::BitDigit);
+
+        addCharacterClass(table, CharacterCodes::space, CharacterClass::WhiteSpace);
+        addCharacterClass(table, CharacterCodes::tab, CharacterClass::WhiteSpace);
+        addCharacterClass(table, CharacterCodes::verticalTab, CharacterClass::WhiteSpace);
+        addCharacterClass(table, CharacterCodes::formFeed, CharacterClass::WhiteSpace);
+        table.flags[CharacterCodes::nextLine] = CharacterClass::WhiteSpace;
+        table.flags[CharacterCodes::nonBreakingSpace] = CharacterClass::WhiteSpace;
+
+        addCharacterClass(table, CharacterCodes::lineFeed, CharacterClass::LineBreak);
+        addCharacterClass(table, CharacterCodes::carriageReturn, CharacterClass::LineBreak);
+
+        addCharacterClass(table, CharacterCodes::singleQuote, CharacterClass::Quote);
+        addCharacterClass(table, CharacterCodes::doubleQuote, CharacterClass::Quote);
+        addCharacterClass(table, CharacterCodes::backtick, CharacterClass::Quote);
+
+        //First characters of the punctuation tokens in `Scanner::scanBuffered()`
+        addCharacterClass(table, CharacterCodes::openBrace, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::closeBrace, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::openParen, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::closeParen, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::caret, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::asterisk, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::minus, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::plus, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::comma, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::bar, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::equals, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::semicolon, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::dot, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::lessThan, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::greaterThan, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::slash, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::colon, CharacterClass::OperatorStart);
+        addCharacterClass(table, CharacterCodes::at, CharacterClass::OperatorStart);
+
+        return table;
+    }
+
+    /**
+     * Classes of U+0000 .. U+00FF, so most predicates below are one load and one mask.
+     */
+    constexpr CharacterClassTable characterClassTable = makeCharacterClassTable();
+
+    /**
+     * Classes of characters past U+00FF
+     */
+    inline uint8_t getWideCharacterClass (int32_t ch) {
+        switch (ch) {
+            case CharacterCodes::lineSeparator:
+            case CharacterCodes::paragraphSeparator:
+                return CharacterClass::LineBreak;
+            case CharacterCodes::ogham:
+            case CharacterCodes::narrowNoBreakSpace:
+            case CharacterCodes::mathematicalSpace:
+            case CharacterCodes::ideographicSpace:
+            case CharacterCodes::byteOrderMark:
+                return CharacterClass::WhiteSpace;
+            default:
+                break;
+        }
+        //Not `zeroWidthSpace`, which is a format character, not a space separator
+        if (ch >= CharacterCodes::enQuad && ch <= CharacterCodes::hairSpace) {
+            return CharacterClass::WhiteSpace;
+        }
+        //Includes `invalidCodePoint`
+        if (ch < 0 || ch > 0xFFFF) {
+            return 0;
+        }
+        return CharacterClass::UnquotedIdentifier;
     }
 
-    bool isAllDigit (std::string const &str) {
-        for (char ch : str) {
-            if (ch < CharacterCodes::_0 || ch > CharacterCodes::_9) {
-                return false;
-            }
+    inline bool hasCharacterClass (int32_t ch, uint8_t flags) {
+        if (static_cast<uint32_t>(ch) < 256) {
+            return (characterClassTable.flags[ch] & flags) != 0;
         }
-        return true;
+        return (getWideCharacterClass(ch) & flags) != 0;
+    }
+
+    inline bool isUnquotedIdentifierCharacter (int32_t ch) {
+        return hasCharacterClass(ch, CharacterClass::UnquotedIdentifier);
+    }
+
+    inline bool isWhiteSpace (int32_t ch) {
+        return hasCharacterClass(ch, CharacterClass::WhiteSpace);
+    }
+
+    inline bool isLineBreak (int32_t ch) {
+        return hasCharacterClass(ch, CharacterClass::LineBreak);
+    }
+
+    inline bool isDigit (int32_t ch) {
+        return hasCharacterClass(ch, CharacterClass::Digit);
+    }
+
+    inline bool isHexDigit (int32_t ch) {
+        return hasCharacterClass(ch, CharacterClass::HexDigit);
+    }
+
+    inline bool isBitDigit (int32_t ch) {
+        return hasCharacterClass(ch, CharacterClass::BitDigit);
+    }
+
+    /**
+     * `'`, `"` and `` ` ``
+     */
+    inline bool isQuote (int32_t ch) {
+        return hasCharacterClass(ch, CharacterClass::Quote);
     }
 
-    bool isDigit (char ch) {
-        return (ch >= CharacterCodes::_0 && ch <= CharacterCodes::_9);
+    inline bool isOperatorStart (int32_t ch) {
+        return hasCharacterClass(ch, CharacterClass::OperatorStart);
     }
 }
 #endif
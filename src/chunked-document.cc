@@ -0,0 +1,199 @@
+#include "./chunked-document.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    using YOUR_LANGUAGE_NAME::DocumentPoint;
+
+    DocumentPoint advancePoint (DocumentPoint point, const char *data, uint64_t length) {
+        auto end = data + length;
+        while (true) {
+            auto lineFeed = static_cast<const char *>(memchr(data, '\n', end - data));
+            if (lineFeed == nullptr) {
+                point.column += end - data;
+                return point;
+            }
+            ++point.row;
+            point.column = 0;
+            data = lineFeed + 1;
+        }
+    }
+
+    DocumentPoint toDocumentPoint (DocumentPoint chunkStart, TSPoint point) {
+        if (point.row == 0) {
+            return DocumentPoint{ chunkStart.row, chunkStart.column + point.column };
+        }
+        return DocumentPoint{ chunkStart.row + point.row, point.column };
+    }
+}
+
+namespace YOUR_LANGUAGE_NAME {
+    ChunkedDocument::ChunkedDocument (const char *data, uint64_t length, size_t targetChunkLength) :
+        data(data),
+        length(length),
+        parser(ts_parser_new())
+    {
+        ts_parser_set_language(parser, tree_sitter_YOUR_LANGUAGE_NAME());
+
+        DocumentPoint point = { 0, 0 };
+        uint64_t pointOffset = 0;
+        splitStatements(
+            data,
+            length,
+            [&] (Statement const &statement) {
+                if (
+                    !documentChunks.empty() &&
+                    documentChunks.back().length + statement.length <= targetChunkLength
+                ) {
+                    documentChunks.back().length += statement.length;
+                    return;
+                }
+
+                point = advancePoint(point, data + pointOffset, statement.offset - pointOffset);
+                pointOffset = statement.offset;
+                documentChunks.push_back(DocumentChunk{
+                    statement.offset,
+                    statement.length,
+                    point,
+                    statement.scannerState
+                });
+            }
+        );
+    }
+
+    ChunkedDocument::~ChunkedDocument () {
+        if (cachedTree != nullptr) {
+            ts_tree_delete(cachedTree);
+        }
+        ts_parser_delete(parser);
+    }
+
+    std::vector<DocumentChunk> const &ChunkedDocument::chunks () const {
+        return documentChunks;
+    }
+
+    size_t ChunkedDocument::chunkAt (uint64_t offset) const {
+        auto after = std::upper_bound(
+            documentChunks.begin(),
+            documentChunks.end(),
+            offset,
+            [] (uint64_t offset, DocumentChunk const &chunk) {
+                return offset < chunk.offset;
+            }
+        );
+        if (after == documentChunks.begin()) {
+            return 0;
+        }
+        return static_cast<size_t>(after - documentChunks.begin()) - 1;
+    }
+
+    TSTree *ChunkedDocument::tree (size_t chunkIndex) {
+        if (cachedTree != nullptr && cachedChunkIndex == chunkIndex) {
+            return cachedTree;
+        }
+        if (cachedTree != nullptr) {
+            ts_tree_delete(cachedTree);
+            cachedTree = nullptr;
+        }
+
+        if (chunkIndex >= documentChunks.size()) {
+            return nullptr;
+        }
+        auto const &chunk = documentChunks[chunkIndex];
+        if (chunk.length > UINT32_MAX) {
+            return nullptr;
+        }
+
+        const char *previousState;
+        auto previousStateLength = tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_get_initial_state(&previousState);
+        std::string savedState(previousState, previousStateLength);
+
+        tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(
+            chunk.scannerState.data(),
+            static_cast<unsigned>(chunk.scannerState.size())
+        );
+        cachedTree = ts_parser_parse_string(
+            parser,
+            nullptr,
+            data + chunk.offset,
+            static_cast<uint32_t>(chunk.length)
+        );
+        tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(
+            savedState.data(),
+            static_cast<unsigned>(savedState.size())
+        );
+        cachedChunkIndex = chunkIndex;
+        return cachedTree;
+    }
+
+    DocumentNode ChunkedDocument::toDocumentNode (size_t chunkIndex, TSNode node) const {
+        auto const &chunk = documentChunks[chunkIndex];
+        return DocumentNode{
+            node,
+            chunk.offset + ts_node_start_byte(node),
+            chunk.offset + ts_node_end_byte(node),
+            toDocumentPoint(chunk.startPoint, ts_node_start_point(node)),
+            toDocumentPoint(chunk.startPoint, ts_node_end_point(node))
+        };
+    }
+
+    void ChunkedDocument::forEachNode (std::function<bool (DocumentNode const &node, unsigned depth)> const &visitor) {
+        for (size_t chunkIndex=0; chunkIndex<documentChunks.size(); ++chunkIndex) {
+            auto chunkTree = tree(chunkIndex);
+            if (chunkTree == nullptr) {
+                continue;
+            }
+
+            TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(chunkTree));
+            //`depth` is one less than the cursor's, the chunk root is not visited
+            unsigned depth = 0;
+            bool visitChildren = true;
+            while (true) {
+                if (visitChildren && ts_tree_cursor_goto_first_child(&cursor)) {
+                    ++depth;
+                } else {
+                    while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+                        if (depth == 0 || !ts_tree_cursor_goto_parent(&cursor)) {
+                            depth = 0;
+                            break;
+                        }
+                        --depth;
+                    }
+                    if (depth == 0) {
+                        break;
+                    }
+                }
+                visitChildren = visitor(
+                    toDocumentNode(chunkIndex, ts_tree_cursor_current_node(&cursor)),
+                    depth - 1
+                );
+            }
+            ts_tree_cursor_delete(&cursor);
+        }
+    }
+
+    DocumentNode ChunkedDocument::descendantForByteRange (uint64_t startByte, uint64_t endByte) {
+        if (documentChunks.empty()) {
+            DocumentNode nullNode;
+            memset(&nullNode, 0, sizeof(nullNode));
+            return nullNode;
+        }
+        auto chunkIndex = chunkAt(startByte);
+        auto const &chunk = documentChunks[chunkIndex];
+        auto chunkTree = tree(chunkIndex);
+
+        TSNode node;
+        memset(&node, 0, sizeof(node));
+        if (chunkTree != nullptr) {
+            auto chunkEnd = chunk.offset + chunk.length;
+            auto start = std::min(std::max(startByte, chunk.offset), chunkEnd) - chunk.offset;
+            auto end = std::min(std::max(endByte, chunk.offset + start), chunkEnd) - chunk.offset;
+            node = ts_node_descendant_for_byte_range(
+                ts_tree_root_node(chunkTree),
+                static_cast<uint32_t>(start),
+                static_cast<uint32_t>(end)
+            );
+        }
+        return toDocumentNode(chunkIndex, node);
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef TREE_SITTER_YOUR_LANGUAGE_NAME_CHUNKED_DOCUMENT_H_
+#define TREE_SITTER_YOUR_LANGUAGE_NAME_CHUNKED_DOCUMENT_H_
+#include <tree_sitter/api.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "./tokenizer.h"
+
+extern "C" {
+    const TSLanguage *tree_sitter_YOUR_LANGUAGE_NAME(void);
+    void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(const char *buffer, unsigned length);
+    unsigned tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_get_initial_state(const char **buffer);
+}
+
+namespace YOUR_LANGUAGE_NAME {
+    /**
+     * Like `TSPoint`, but wide enough for any document.
+     * `row` and `column` start at zero, `column` counts bytes.
+     */
+    struct DocumentPoint {
+        uint64_t row;
+        uint64_t column;
+    };
+
+    /**
+     * A node of one chunk's tree, with its position in the whole document.
+     * `node` is only valid while the chunk's tree is.
+     */
+    struct DocumentNode {
+        TSNode node;
+        uint64_t startByte;
+        uint64_t endByte;
+        DocumentPoint startPoint;
+        DocumentPoint endPoint;
+    };
+
+    /**
+     * A run of whole statements that is parsed as one tree.
+     */
+    struct DocumentChunk {
+        uint64_t offset;
+        uint64_t length;
+        DocumentPoint startPoint;
+        /**
+         * Serialized external scanner state at `offset`
+         */
+        std::string scannerState;
+    };
+
+    /**
+     * One logical document over input of any size, even past tree-sitter's 32-bit offsets.
+     *
+     * The input is split at statement boundaries into chunks of about `targetChunkLength` bytes
+     * (a chunk holds at least one statement, so it can be larger).
+     * Each chunk is parsed on its own, under the `DELIMITER` active where it starts,
+     * and node positions are reported relative to the whole document.
+     *
+     * Only chunk boundaries are kept. Chunks are parsed when they are visited,
+     * and only the most recently parsed tree is kept, so memory does not grow with the document.
+     *
+     * `data` must outlive the document. Not thread safe.
+     */
+    class ChunkedDocument {
+        public:
+            ChunkedDocument (const char *data, uint64_t length, size_t targetChunkLength = 256 * 1024);
+            ~ChunkedDocument ();
+
+            ChunkedDocument (ChunkedDocument const &) = delete;
+            ChunkedDocument &operator= (ChunkedDocument const &) = delete;
+
+            std::vector<DocumentChunk> const &chunks () const;
+
+            /**
+             * Index of the chunk that holds `offset`, or the last chunk if `offset` is past the end.
+             * An empty document has no chunks, so this is 0, which is not a valid index.
+             */
+            size_t chunkAt (uint64_t offset) const;
+
+            /**
+             * Parses the chunk, unless it was the last one parsed.
+             * The tree belongs to the document, and stays valid until another chunk is parsed.
+             *
+             * Returns null for a chunk that is too long for tree-sitter (4 GiB or more),
+             * or for an index past the last chunk.
+             *
+             * The thread's initial scanner state is set for the parse, and put back right after.
+             */
+            TSTree *tree (size_t chunkIndex);
+
+            DocumentNode toDocumentNode (size_t chunkIndex, TSNode node) const;
+
+            /**
+             * Visits every node of the document in order, parents before children.
+             * The root of each chunk is not visited, so the top-level nodes of all chunks
+             * read as the children of one document; they have `depth == 0`.
+             *
+             * Return false from `visitor` to skip the node's children.
+             */
+            void forEachNode (std::function<bool (DocumentNode const &node, unsigned depth)> const &visitor);
+
+            /**
+             * Smallest node that spans `[startByte, endByte)`, within the chunk that holds `startByte`.
+             * A null node (all zero) for an empty document.
+             */
+            DocumentNode descendantForByteRange (uint64_t startByte, uint64_t endByte);
+
+        private:
+            const char *data;
+            uint64_t length;
+            std::vector<DocumentChunk> documentChunks;
+            TSParser *parser;
+            TSTree *cachedTree = nullptr;
+            size_t cachedChunkIndex = 0;
+    };
+}
+
+#endif
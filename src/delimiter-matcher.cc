@@ -0,0 +1,150 @@
+#ifndef DELIMITER_MATCHER_CC
+#define DELIMITER_MATCHER_CC
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "./character-code.cc"
+#include "./utf8.cc"
+
+namespace {
+    /**
+     * The active custom delimiter, plus facts about it that are computed once
+     * (in `scanDelimiter()` and `deserialize()`) instead of on every character.
+     *
+     * An empty delimiter means the "original" `;` delimiter is in use.
+     *
+     * Kept both as code points, to match against the scanner's lookahead,
+     * and as UTF-8, for scanner state.
+     *
+     * Stored inline, so copying it in and out of scanner state never allocates.
+     * Delimiters longer than `maxLength` characters are rejected, not truncated;
+     * with 4 bytes per character and a byte of flags, they would not fit in scanner state anyway.
+     */
+    struct DelimiterMatcher {
+        static const size_t maxLength = 255;
+        static const size_t maxEncodedLength = maxLength * 4;
+
+        int32_t text[maxLength];
+        uint8_t length = 0;
+        char encoded[maxEncodedLength];
+        uint16_t encodedLength = 0;
+        /**
+         * If false, the delimiter can never start in the middle of an unquoted identifier,
+         * so identifier scanning does not need to look for it.
+         *
+         * This is the case for delimiters like `//` and `;;`.
+         */
+        bool interruptsUnquotedIdentifier = false;
+
+        /**
+         * From scanned characters.
+         * Does nothing if `delimiter` is already the active delimiter.
+         * Returns false, and changes nothing, if it is longer than `maxLength`.
+         */
+        bool compile (const int32_t *delimiter, size_t length) {
+            if (length > maxLength) {
+                return false;
+            }
+            if (length == this->length && memcmp(text, delimiter, length * sizeof(int32_t)) == 0) {
+                return true;
+            }
+            if (length > 0) {
+                memcpy(text, delimiter, length * sizeof(int32_t));
+            }
+            this->length = static_cast<uint8_t>(length);
+
+            encodedLength = 0;
+            for (size_t i=0; i<length; ++i) {
+                encodedLength += encodeUtf8(text[i], encoded + encodedLength);
+            }
+            updateFlags();
+            return true;
+        }
+
+        /**
+         * True if the UTF-8 `delimiter` is at most `maxLength` characters
+         * (and so at most `maxEncodedLength` bytes).
+         */
+        static bool fitsEncoded (const char *delimiter, size_t length) {
+            if (length > maxEncodedLength) {
+                return false;
+            }
+            size_t characterCount = 0;
+            size_t index = 0;
+            int32_t ch = 0;
+            while (index < length) {
+                if (characterCount == maxLength) {
+                    return false;
+                }
+                index += decodeUtf8(delimiter + index, length - index, ch);
+                ++characterCount;
+            }
+            return true;
+        }
+
+        /**
+         * From UTF-8, as written to scanner state.
+         * Does nothing if `delimiter` is already the active delimiter.
+         * Returns false, and changes nothing, if it does not `fitsEncoded()`.
+         */
+        bool compileEncoded (const char *delimiter, size_t length) {
+            if (!fitsEncoded(delimiter, length)) {
+                return false;
+            }
+            if (length == encodedLength && memcmp(encoded, delimiter, length) == 0) {
+                return true;
+            }
+            if (length > 0) {
+                memcpy(encoded, delimiter, length);
+            }
+            encodedLength = static_cast<uint16_t>(length);
+
+            this->length = 0;
+            size_t index = 0;
+            while (index < length) {
+                index += decodeUtf8(encoded + index, length - index, text[this->length]);
+                ++this->length;
+            }
+            updateFlags();
+            return true;
+        }
+
+        void updateFlags () {
+            interruptsUnquotedIdentifier = (
+                length > 0 &&
+                isUnquotedIdentifierCharacter(text[0])
+            );
+        }
+
+        void clear () {
+            length = 0;
+            encodedLength = 0;
+            interruptsUnquotedIdentifier = false;
+        }
+
+        const int32_t *data () const {
+            return text;
+        }
+
+        size_t size () const {
+            return length;
+        }
+
+        const char *encodedData () const {
+            return encoded;
+        }
+
+        size_t encodedSize () const {
+            return encodedLength;
+        }
+
+        /**
+         * Cheap first-character check. Only when this is true
+         * does the caller need to look further ahead to confirm a match.
+         */
+        bool mayStartWith (int32_t ch) const {
+            return length > 0 && text[0] == ch;
+        }
+    };
+}
+#endif
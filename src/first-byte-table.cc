@@ -0,0 +1,164 @@
+#ifndef FIRST_BYTE_TABLE_CC
+#define FIRST_BYTE_TABLE_CC
+#include <cstdint>
+#include "./character-code.cc"
+#include "./token-kind.cc"
+
+namespace {
+    /**
+     * What `Scanner::scanBuffered()` does with a token, given its first byte.
+     */
+    struct FirstByteEntry {
+        enum Action : uint8_t {
+            /**
+             * Identifiers, keywords, number literals, and anything unknown
+             */
+            Others,
+            /**
+             * `d`, `D`; may start `DELIMITER `
+             */
+            MaybeDelimiterStatement,
+            WhiteSpace,
+            CarriageReturn,
+            LineFeed,
+            /**
+             * `x`, `X`; may start `X'...'`
+             */
+            MaybeHexLiteral,
+            /**
+             * `b`, `B`; may start `B'...'`
+             */
+            MaybeBitLiteral,
+            /**
+             * `0`; may start `0x...` or `0b...`
+             */
+            Zero,
+            /**
+             * Always a one-character token, `tokenType`
+             */
+            SingleCharacter,
+            LessThan,
+            GreaterThan,
+            SingleQuote,
+            Slash,
+            Colon,
+            At,
+            QuotedIdentifier,
+            /**
+             * `#`; starts a single-line comment
+             */
+            Pound,
+            /**
+             * `-`; may start a `-- ` single-line comment
+             */
+            Minus,
+        };
+
+        Action action;
+        /**
+         * Only used by `SingleCharacter`
+         */
+        uint16_t tokenType;
+    };
+
+    struct FirstByteTable {
+        FirstByteEntry entries[256];
+
+        constexpr FirstByteEntry operator[] (unsigned char ch) const {
+            return entries[ch];
+        }
+    };
+
+    constexpr void setFirstByteAction (FirstByteTable &table, unsigned char ch, FirstByteEntry::Action action) {
+        table.entries[ch].action = action;
+    }
+
+    constexpr void setSingleCharacterToken (FirstByteTable &table, unsigned char ch, TokenType tokenType) {
+        table.entries[ch].action = FirstByteEntry::SingleCharacter;
+        table.entries[ch].tokenType = static_cast<uint16_t>(tokenType);
+    }
+
+    constexpr FirstByteTable makeFirstByteTable () {
+        //Everything not listed below is `Others`
+        FirstByteTable table = {};
+
+        setFirstByteAction(table, CharacterCodes::space, FirstByteEntry::WhiteSpace);
+        setFirstByteAction(table, CharacterCodes::tab, FirstByteEntry::WhiteSpace);
+        setFirstByteAction(table, CharacterCodes::verticalTab, FirstByteEntry::WhiteSpace);
+        setFirstByteAction(table, CharacterCodes::formFeed, FirstByteEntry::WhiteSpace);
+
+        setFirstByteAction(table, CharacterCodes::carriageReturn, FirstByteEntry::CarriageReturn);
+        setFirstByteAction(table, CharacterCodes::lineFeed, FirstByteEntry::LineFeed);
+
+        setFirstByteAction(table, CharacterCodes::d, FirstByteEntry::MaybeDelimiterStatement);
+        setFirstByteAction(table, CharacterCodes::D, FirstByteEntry::MaybeDelimiterStatement);
+        setFirstByteAction(table, CharacterCodes::x, FirstByteEntry::MaybeHexLiteral);
+        setFirstByteAction(table, CharacterCodes::X, FirstByteEntry::MaybeHexLiteral);
+        setFirstByteAction(table, CharacterCodes::b, FirstByteEntry::MaybeBitLiteral);
+        setFirstByteAction(table, CharacterCodes::B, FirstByteEntry::MaybeBitLiteral);
+        setFirstByteAction(table, CharacterCodes::_0, FirstByteEntry::Zero);
+
+        setSingleCharacterToken(table, CharacterCodes::openBrace, TokenType::OpenBrace);
+        setSingleCharacterToken(table, CharacterCodes::closeBrace, TokenType::CloseBrace);
+        setSingleCharacterToken(table, CharacterCodes::openParen, TokenType::OpenParentheses);
+        setSingleCharacterToken(table, CharacterCodes::closeParen, TokenType::CloseParentheses);
+        setSingleCharacterToken(table, CharacterCodes::caret, TokenType::Caret);
+        setSingleCharacterToken(table, CharacterCodes::asterisk, TokenType::Asterisk);
+        setSingleCharacterToken(table, CharacterCodes::plus, TokenType::Plus);
+        setSingleCharacterToken(table, CharacterCodes::comma, TokenType::Comma);
+        setSingleCharacterToken(table, CharacterCodes::bar, TokenType::Bar);
+        setSingleCharacterToken(table, CharacterCodes::equals, TokenType::Equal);
+        setSingleCharacterToken(table, CharacterCodes::semicolon, TokenType::SemiColon);
+        setSingleCharacterToken(table, CharacterCodes::dot, TokenType::Dot);
+
+        setFirstByteAction(table, CharacterCodes::lessThan, FirstByteEntry::LessThan);
+        setFirstByteAction(table, CharacterCodes::greaterThan, FirstByteEntry::GreaterThan);
+        setFirstByteAction(table, CharacterCodes::singleQuote, FirstByteEntry::SingleQuote);
+        setFirstByteAction(table, CharacterCodes::slash, FirstByteEntry::Slash);
+        setFirstByteAction(table, CharacterCodes::colon, FirstByteEntry::Colon);
+        setFirstByteAction(table, CharacterCodes::at, FirstByteEntry::At);
+        setFirstByteAction(table, CharacterCodes::doubleQuote, FirstByteEntry::QuotedIdentifier);
+        setFirstByteAction(table, CharacterCodes::backtick, FirstByteEntry::QuotedIdentifier);
+        setFirstByteAction(table, CharacterCodes::pound, FirstByteEntry::Pound);
+        setFirstByteAction(table, CharacterCodes::minus, FirstByteEntry::Minus);
+
+        return table;
+    }
+
+    /**
+     * Built at compile time, so dispatching on the first byte of a token
+     * is one load and one jump instead of a chain of comparisons.
+     */
+    constexpr FirstByteTable firstByteTable = makeFirstByteTable();
+
+    /**
+     * Characters past ASCII are never punctuation,
+     * they are whitespace, a one-character line break like `\n` (U+2028, U+2029),
+     * or handled by `Others`.
+     */
+    inline FirstByteEntry getFirstByteEntry (int32_t ch) {
+        if (static_cast<uint32_t>(ch) < 0x80) {
+            return firstByteTable[static_cast<unsigned char>(ch)];
+        }
+        FirstByteEntry result = {
+            isWhiteSpace(ch) ? FirstByteEntry::WhiteSpace :
+            isLineBreak(ch) ? FirstByteEntry::LineFeed :
+            FirstByteEntry::Others,
+            0
+        };
+        return result;
+    }
+
+    /**
+     * No token starts with these, so they can only ever be scanned as `UnknownToken`.
+     * Includes invalid UTF-8, but not the end of input.
+     */
+    inline bool isUnknownTokenCharacter (int32_t ch) {
+        return (
+            ch != 0 &&
+            getFirstByteEntry(ch).action == FirstByteEntry::Others &&
+            !isUnquotedIdentifierCharacter(ch)
+        );
+    }
+}
+#endif
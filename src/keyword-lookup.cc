@@ -0,0 +1,246 @@
+#ifndef KEYWORD_LOOKUP_CC
+#define KEYWORD_LOOKUP_CC
+#include <cstddef>
+#include <cstdint>
+#include "./token-kind.cc"
+
+namespace {
+    /**
+     * Case-insensitive keyword recognizer.
+     *
+     * The table is a perfect hash table built at compile time from `keywordEntries`,
+     * by hash and displace: the top bits of the hash pick a bucket,
+     * and each bucket has a displacement that scatters its keywords into free slots.
+     * Buckets are placed largest first, trying displacements until one fits.
+     * Every slot stores the full hash and length of its keyword,
+     * so a lookup is one hash, exactly one slot, and one string compare.
+     *
+     * Most identifiers are rejected before the table is touched,
+     * by checking their length and first byte against masks of all keywords.
+     */
+    struct KeywordHashSlot {
+        const char *text;
+        uint32_t hash;
+        uint16_t tokenType;
+        uint8_t length;
+    };
+
+    constexpr size_t keywordHashTableBits = 11;
+    constexpr size_t keywordHashTableSize = size_t(1) << keywordHashTableBits;
+    constexpr size_t keywordBucketBits = 8;
+    constexpr size_t keywordBucketCount = size_t(1) << keywordBucketBits;
+    /**
+     * Displacements tried per bucket before giving up
+     */
+    constexpr uint32_t keywordMaxDisplacement = 4096;
+    constexpr uint32_t keywordHashBasis = 2166136261u;
+    constexpr uint32_t keywordHashPrime = 16777619u;
+
+    constexpr unsigned char toUpperAscii (unsigned char ch) {
+        return (ch >= 'a' && ch <= 'z') ? static_cast<unsigned char>(ch - ('a' - 'A')) : ch;
+    }
+
+    /**
+     * FNV-1a over the upper-cased bytes.
+     * Exposed one step at a time so scanners can hash while they consume characters.
+     */
+    constexpr uint32_t keywordHashStep (uint32_t hash, unsigned char ch) {
+        return (hash ^ toUpperAscii(ch)) * keywordHashPrime;
+    }
+
+    constexpr size_t constexprStrlen (const char *str) {
+        size_t result = 0;
+        while (str[result] != 0) {
+            ++result;
+        }
+        return result;
+    }
+
+    constexpr size_t keywordBucket (uint32_t hash) {
+        return hash >> (32 - keywordBucketBits);
+    }
+
+    /**
+     * Multiplicative hash of the displaced hash, so every bit of it reaches the slot
+     */
+    constexpr size_t keywordSlot (uint32_t hash, uint16_t displacement) {
+        return static_cast<uint32_t>((hash ^ (displacement * 0x9E3779B9u)) * 0x85EBCA6Bu) >> (32 - keywordHashTableBits);
+    }
+
+    constexpr size_t keywordCount = sizeof(keywordEntries) / sizeof(keywordEntries[0]);
+
+    struct KeywordHashTable {
+        KeywordHashSlot slots[keywordHashTableSize];
+        uint16_t displacements[keywordBucketCount];
+        /**
+         * Bit `n` is set if some keyword has length `n`.
+         */
+        uint64_t lengthMask;
+        /**
+         * Bit `n` is set if some keyword starts with `'A' + n`.
+         */
+        uint32_t firstLetterMask;
+        /**
+         * Keywords no displacement could place, must be zero
+         */
+        size_t unplacedCount;
+        size_t maxLength;
+    };
+
+    constexpr KeywordHashTable buildKeywordHashTable () {
+        KeywordHashTable table{};
+        for (size_t i=0; i<keywordHashTableSize; ++i) {
+            table.slots[i] = KeywordHashSlot{ nullptr, 0, 0, 0 };
+        }
+
+        uint32_t hashes[keywordCount] = {};
+        size_t bucketStarts[keywordBucketCount + 1] = {};
+        for (size_t k=0; k<keywordCount; ++k) {
+            const auto &entry = keywordEntries[k];
+            auto length = constexprStrlen(entry.text);
+            uint32_t hash = keywordHashBasis;
+            for (size_t i=0; i<length; ++i) {
+                hash = keywordHashStep(hash, static_cast<unsigned char>(entry.text[i]));
+            }
+            hashes[k] = hash;
+            ++bucketStarts[keywordBucket(hash) + 1];
+
+            table.lengthMask |= uint64_t(1) << length;
+            table.firstLetterMask |= uint32_t(1) << (entry.text[0] - 'A');
+            if (length > table.maxLength) {
+                table.maxLength = length;
+            }
+        }
+
+        //Keywords sorted by bucket
+        size_t maxBucketSize = 0;
+        for (size_t b=0; b<keywordBucketCount; ++b) {
+            if (bucketStarts[b + 1] > maxBucketSize) {
+                maxBucketSize = bucketStarts[b + 1];
+            }
+            bucketStarts[b + 1] += bucketStarts[b];
+        }
+        size_t bucketFill[keywordBucketCount] = {};
+        size_t order[keywordCount] = {};
+        for (size_t k=0; k<keywordCount; ++k) {
+            auto bucket = keywordBucket(hashes[k]);
+            order[bucketStarts[bucket] + bucketFill[bucket]] = k;
+            ++bucketFill[bucket];
+        }
+
+        for (size_t size=maxBucketSize; size>0; --size) {
+            for (size_t b=0; b<keywordBucketCount; ++b) {
+                auto start = bucketStarts[b];
+                if (bucketStarts[b + 1] - start != size) {
+                    continue;
+                }
+
+                bool placed = false;
+                for (uint32_t displacement=0; !placed && displacement<keywordMaxDisplacement; ++displacement) {
+                    //Claim slots one keyword at a time, and give them back if one is taken
+                    size_t claimed = 0;
+                    while (claimed < size) {
+                        auto k = order[start + claimed];
+                        auto index = keywordSlot(hashes[k], static_cast<uint16_t>(displacement));
+                        if (table.slots[index].text != nullptr) {
+                            break;
+                        }
+                        table.slots[index] = KeywordHashSlot{
+                            keywordEntries[k].text,
+                            hashes[k],
+                            static_cast<uint16_t>(keywordEntries[k].tokenType),
+                            static_cast<uint8_t>(constexprStrlen(keywordEntries[k].text))
+                        };
+                        ++claimed;
+                    }
+                    if (claimed == size) {
+                        table.displacements[b] = static_cast<uint16_t>(displacement);
+                        placed = true;
+                    } else {
+                        for (size_t i=0; i<claimed; ++i) {
+                            auto k = order[start + i];
+                            table.slots[keywordSlot(hashes[k], static_cast<uint16_t>(displacement))] = KeywordHashSlot{ nullptr, 0, 0, 0 };
+                        }
+                    }
+                }
+                if (!placed) {
+                    table.unplacedCount += size;
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr KeywordHashTable keywordHashTable = buildKeywordHashTable();
+
+    static_assert(
+        keywordHashTable.unplacedCount == 0,
+        "Keyword hash table is not perfect, grow keywordHashTableSize or keywordBucketCount"
+    );
+
+    /**
+     * Identifiers longer than this can never be keywords.
+     */
+    constexpr size_t keywordMaxLength = 32;
+
+    static_assert(
+        keywordHashTable.maxLength <= keywordMaxLength,
+        "keywordMaxLength must fit the longest keyword"
+    );
+
+    /**
+     * Cheap rejection that only looks at the length and first byte.
+     */
+    inline bool mayBeKeyword (const char *str, size_t length) {
+        if (length >= 64 || ((keywordHashTable.lengthMask >> length) & 1) == 0) {
+            return false;
+        }
+        unsigned letter = toUpperAscii(static_cast<unsigned char>(str[0])) - 'A';
+        return letter < 26 && ((keywordHashTable.firstLetterMask >> letter) & 1) != 0;
+    }
+
+    inline bool equalsKeywordCaseInsensitive (const char *str, const char *keyword, size_t length) {
+        for (size_t i=0; i<length; ++i) {
+            if (toUpperAscii(static_cast<unsigned char>(str[i])) != static_cast<unsigned char>(keyword[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * `hash` must be the `keywordHashStep()` fold of `str`.
+     * Returns -1 if `str` is not a keyword.
+     */
+    inline int tryGetKeywordTokenTypeHashed (const char *str, size_t length, uint32_t hash) {
+        if (!mayBeKeyword(str, length)) {
+            return -1;
+        }
+
+        const auto &slot = keywordHashTable.slots[
+            keywordSlot(hash, keywordHashTable.displacements[keywordBucket(hash)])
+        ];
+        if (
+            slot.text != nullptr &&
+            slot.hash == hash &&
+            slot.length == length &&
+            equalsKeywordCaseInsensitive(str, slot.text, length)
+        ) {
+            return slot.tokenType;
+        }
+        return -1;
+    }
+
+    inline int tryGetKeywordTokenType (const char *str, size_t length) {
+        if (!mayBeKeyword(str, length)) {
+            return -1;
+        }
+
+        uint32_t hash = keywordHashBasis;
+        for (size_t i=0; i<length; ++i) {
+            hash = keywordHashStep(hash, static_cast<unsigned char>(str[i]));
+        }
+        return tryGetKeywordTokenTypeHashed(str, length, hash);
+    }
+}
+#endif
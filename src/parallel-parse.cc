@@ -0,0 +1,144 @@
+#include "./parallel-parse.h"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+    /**
+     * One worker's share of the statements.
+     * The owner takes from the front, thieves take from the back,
+     * so neighbouring statements tend to stay on one thread.
+     */
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> statementIndices;
+
+        bool popFront (size_t &result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (statementIndices.empty()) {
+                return false;
+            }
+            result = statementIndices.front();
+            statementIndices.pop_front();
+            return true;
+        }
+
+        bool stealBack (size_t &result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (statementIndices.empty()) {
+                return false;
+            }
+            result = statementIndices.back();
+            statementIndices.pop_back();
+            return true;
+        }
+    };
+
+    bool takeStatement (std::vector<WorkQueue> &queues, size_t self, size_t &result) {
+        if (queues[self].popFront(result)) {
+            return true;
+        }
+        for (size_t i=1; i<queues.size(); ++i) {
+            if (queues[(self + i) % queues.size()].stealBack(result)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void parseWorker (
+        const char *data,
+        std::vector<YOUR_LANGUAGE_NAME::Statement> const &statements,
+        std::vector<WorkQueue> &queues,
+        size_t self,
+        std::vector<TSTree *> &trees
+    ) {
+        TSParser *parser = ts_parser_new();
+        ts_parser_set_language(parser, tree_sitter_YOUR_LANGUAGE_NAME());
+
+        //Worker 0 is the calling thread, which may have its own initial state
+        const char *previousState;
+        auto previousStateLength = tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_get_initial_state(&previousState);
+        std::string savedState(previousState, previousStateLength);
+
+        size_t statementIndex;
+        while (takeStatement(queues, self, statementIndex)) {
+            auto const &statement = statements[statementIndex];
+            if (statement.length > UINT32_MAX) {
+                //Too long for tree-sitter's 32-bit offsets
+                continue;
+            }
+            tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(
+                statement.scannerState.data(),
+                static_cast<unsigned>(statement.scannerState.size())
+            );
+            trees[statementIndex] = ts_parser_parse_string(
+                parser,
+                nullptr,
+                data + statement.offset,
+                static_cast<uint32_t>(statement.length)
+            );
+        }
+
+        tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(
+            savedState.data(),
+            static_cast<unsigned>(savedState.size())
+        );
+        ts_parser_delete(parser);
+    }
+}
+
+namespace YOUR_LANGUAGE_NAME {
+    std::vector<TSTree *> parseStatements (
+        const char *data,
+        std::vector<Statement> const &statements,
+        unsigned threadCount
+    ) {
+        std::vector<TSTree *> trees(statements.size(), nullptr);
+        if (statements.empty()) {
+            return trees;
+        }
+
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, statements.size()));
+
+        //Contiguous blocks, so each worker starts on its own part of the file
+        std::vector<WorkQueue> queues(threadCount);
+        for (size_t i=0; i<statements.size(); ++i) {
+            queues[i * threadCount / statements.size()].statementIndices.push_back(i);
+        }
+
+        std::vector<std::thread> threads;
+        for (size_t i=1; i<threadCount; ++i) {
+            threads.emplace_back(
+                parseWorker,
+                data,
+                std::cref(statements),
+                std::ref(queues),
+                i,
+                std::ref(trees)
+            );
+        }
+        parseWorker(data, statements, queues, 0, trees);
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        return trees;
+    }
+
+    std::vector<TSTree *> parseStatements (
+        const char *data,
+        size_t length,
+        std::vector<Statement> &statements,
+        unsigned threadCount
+    ) {
+        splitStatements(data, length, statements);
+        return parseStatements(data, statements, threadCount);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef TREE_SITTER_YOUR_LANGUAGE_NAME_PARALLEL_PARSE_H_
+#define TREE_SITTER_YOUR_LANGUAGE_NAME_PARALLEL_PARSE_H_
+#include <tree_sitter/api.h>
+#include <cstddef>
+#include <vector>
+#include "./tokenizer.h"
+
+extern "C" {
+    const TSLanguage *tree_sitter_YOUR_LANGUAGE_NAME(void);
+    void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(const char *buffer, unsigned length);
+    unsigned tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_get_initial_state(const char **buffer);
+}
+
+namespace YOUR_LANGUAGE_NAME {
+    /**
+     * Parses every statement on its own, on `threadCount` threads (0 means one per core).
+     *
+     * Each worker owns one `TSParser`, and its external scanner starts
+     * under the `DELIMITER` recorded in `Statement::scannerState`.
+     * Idle workers steal statements from busy ones.
+     *
+     * Returns one tree per statement, in source order. Node positions are relative
+     * to `Statement::offset`. The caller owns the trees and frees them with `ts_tree_delete()`.
+     * A statement of 4 GiB or more is too long for tree-sitter, and gets a null tree.
+     *
+     * The calling thread also parses, and keeps the initial scanner state it had before.
+     */
+    std::vector<TSTree *> parseStatements (
+        const char *data,
+        std::vector<Statement> const &statements,
+        unsigned threadCount = 0
+    );
+
+    /**
+     * `splitStatements()` followed by `parseStatements()`.
+     */
+    std::vector<TSTree *> parseStatements (
+        const char *data,
+        size_t length,
+        std::vector<Statement> &statements,
+        unsigned threadCount = 0
+    );
+}
+
+#endif
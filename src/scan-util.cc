@@ -1,17 +1,39 @@
 #include <string>
-#include <regex>
 #include "./character-code.cc"
 #include "./buffered-lexer.cc"
 #include "./token-kind.cc"
+#include "./keyword-lookup.cc"
+#include "./delimiter-matcher.cc"
+#include "./scanner-stats.cc"
 
 namespace {
-    bool tryScanQuotedString (TmpLexer &lexer) {
+    /**
+     * Bits in `Scanner::unterminatedTokens`, past the ones from `quotedIdentifierBit()`
+     */
+    const uint8_t unterminatedStringBit = 8;
+    const uint8_t unterminatedMultiLineCommentBit = 16;
+
+    /**
+     * Commits as it goes, so a long string literal does not have to be buffered.
+     *
+     * If it does not encounter a closing quote,
+     * the end of the token is marked just before the first line break in the string
+     * (or at EOF, if there is none), like `scanQuotedIdentifier()` does.
+     * `lexer` is then left behind the committed position, so callers must return right away.
+     *
+     * Reaching EOF sets `unterminatedStringBit`,
+     * after which later scans stop at their first line break.
+     */
+    bool tryScanQuotedString (TmpLexer &lexer, uint8_t &unterminatedTokens) {
         TmpLexer tmp(lexer);
         auto quote = tmp.advance();
+        auto knownUnterminated = (unterminatedTokens & unterminatedStringBit) != 0;
 
+        bool foundLineBreak = false;
         //std::string result;
 
         while (!tmp.isEof(0)) {
+            tmp.commitIfFar();
             auto ch = tmp.peek(0);
             if (ch == quote) {
                 if (tmp.peek(1) == quote) {
@@ -62,57 +84,82 @@ namespace {
                         break;
                 }
             } else {
+                if (!foundLineBreak && isLineBreak(ch)) {
+                    //Tentative end, in case the string is never closed
+                    tmp.markEnd();
+                    lexer.index = tmp.index;
+                    foundLineBreak = true;
+                    if (knownUnterminated) {
+                        return false;
+                    }
+                }
                 tmp.advance();
                 //result += tmp.advance();
             }
         }
 
+        unterminatedTokens |= unterminatedStringBit;
+
+        if (!foundLineBreak) {
+            tmp.markEnd();
+            lexer.index = tmp.index;
+        }
         return false;
     }
 
+    /**
+     * Sets `result_symbol` even if `tokenType` is not valid,
+     * so the caller can tell which token was rejected.
+     */
     bool lexerResult (TSLexer *lexer, const bool *valid_symbols, TokenType tokenType) {
         //std::cout << "lexerResult: " << tokenType << std::endl;
-        if (valid_symbols[tokenType]) {
-            lexer->result_symbol = tokenType;
-            return true;
-        } else {
-            return false;
-        }
+#ifdef SCANNER_STATS
+        recordScanResult(tokenType, valid_symbols[tokenType]);
+#endif
+        lexer->result_symbol = tokenType;
+        return valid_symbols[tokenType];
+    }
+
+    /**
+     * Only tree-sitter's error recovery state accepts every external token,
+     * including `START_OF_RESERVED_KEYWORD`, which no rule uses.
+     */
+    bool isErrorRecovery (const bool *valid_symbols) {
+        return valid_symbols[TokenType::START_OF_RESERVED_KEYWORD];
     }
 
     bool lexerForcedResult (TSLexer *lexer, TokenType tokenType) {
+#ifdef SCANNER_STATS
+        recordScanResult(tokenType, true);
+#endif
         lexer->result_symbol = tokenType;
         return true;
     }
 
     bool lexerEofResult (TSLexer *lexer) {
+#ifdef SCANNER_STATS
+        recordScanResult(TokenType::EndOfFile, true);
+#endif
         lexer->result_symbol = TokenType::EndOfFile;
         return true;
     }
 
-    std::regex regex0xHexLiteral(
-        "^0x[0-9a-fA-F]+$",
-        std::regex_constants::ECMAScript
-    );
-
-    bool is0xHexLiteral (std::string const &str) {
-        return std::regex_match(str, regex0xHexLiteral);
-    }
-
-    std::regex regex0bBitLiteral(
-        "^0b[01]+$",
-        std::regex_constants::ECMAScript
-    );
-
-    bool is0bBitLiteral (std::string const &str) {
-        return std::regex_match(str, regex0bBitLiteral);
-    }
-
-    bool tryScanTillEndOfMultiLineComment (TmpLexer &lexer) {
+    /**
+     * Commits as it goes, so a long comment does not have to be buffered.
+     *
+     * An unclosed comment is handled like an unclosed string in `tryScanQuotedString()`,
+     * ending at its first line break, with `unterminatedMultiLineCommentBit`.
+     */
+    bool tryScanTillEndOfMultiLineComment (TmpLexer &lexer, uint8_t &unterminatedTokens) {
         TmpLexer tmp(lexer);
+        auto knownUnterminated = (unterminatedTokens & unterminatedMultiLineCommentBit) != 0;
+
+        bool foundLineBreak = false;
         while (!tmp.isEof(0)) {
+            tmp.commitIfFar();
+            auto ch = tmp.peek(0);
             if (
-                tmp.peek(0) == CharacterCodes::asterisk &&
+                ch == CharacterCodes::asterisk &&
                 tmp.peek(1) == CharacterCodes::slash
             ) {
                 tmp.advance();
@@ -122,23 +169,43 @@ namespace {
                 return true;
             }
 
+            if (!foundLineBreak && isLineBreak(ch)) {
+                //Tentative end, in case the comment is never closed
+                tmp.markEnd();
+                lexer.index = tmp.index;
+                foundLineBreak = true;
+                if (knownUnterminated) {
+                    //No comment after this point is closed either
+                    return false;
+                }
+            }
             tmp.advance();
         }
 
+        unterminatedTokens |= unterminatedMultiLineCommentBit;
+
+        if (!foundLineBreak) {
+            tmp.markEnd();
+            lexer.index = tmp.index;
+        }
         return false;
     }
 
-    bool tryScanString(TmpLexer &lexer, std::string const &str, bool markEnd = true) {
+    /**
+     * `Character` is `char` for ASCII strings, and `int32_t` for code points.
+     */
+    template <typename Character>
+    bool tryScanString(TmpLexer &lexer, const Character *str, size_t length, bool markEnd = true) {
         TmpLexer tmp(lexer);
         //Try to match all characters in the given 'str'
-        for (size_t i=0; i<str.size(); ++i) {
-            auto c = str[i];
+        for (size_t i=0; i<length; ++i) {
+            auto c = static_cast<int32_t>(str[i]);
             if (tmp.peek(i) != c) {
                 return false;
             }
         }
 
-        for (size_t i=0; i<str.size(); ++i) {
+        for (size_t i=0; i<length; ++i) {
             //Consume the character in 'c'
             tmp.advance();
         }
@@ -150,13 +217,16 @@ namespace {
         return true;
     }
 
+    bool tryScanString(TmpLexer &lexer, DelimiterMatcher const &delimiter, bool markEnd = true) {
+        return tryScanString(lexer, delimiter.data(), delimiter.size(), markEnd);
+    }
 
-    bool tryScanStringCaseInsensitive(TmpLexer &lexer, std::string const &str) {
+    bool tryScanStringCaseInsensitive(TmpLexer &lexer, std::string const &str, bool markEnd = true) {
         TmpLexer tmp(lexer);
         //Try to match all characters in the given 'str'
         for (size_t i=0; i<str.size(); ++i) {
-            auto c = str[i];
-            if (toupper(tmp.peek(i)) != toupper(c)) {
+            auto ch = tmp.peek(i);
+            if (ch < 0 || ch > CharacterCodes::maxAsciiCharacter || toupper(ch) != toupper(str[i])) {
                 return false;
             }
         }
@@ -166,22 +236,151 @@ namespace {
             tmp.advance();
         }
 
-        tmp.markEnd();
-        lexer.index = tmp.index;
+        if (markEnd) {
+            tmp.markEnd();
+            lexer.index = tmp.index;
+        }
         return true;
     }
 
+    /**
+     * Summary of an unquoted identifier, built one character at a time while it is scanned.
+     * Only the first `keywordMaxLength` characters are kept,
+     * which is enough to tell whether it is a keyword.
+     */
+    struct UnquotedIdentifier {
+        enum NumberShape {
+            //[0-9]*
+            Digits,
+            //[0-9]+[eE]
+            DigitsE,
+            //[0-9]+[eE][0-9]+
+            DigitsEDigits,
+            NotNumber,
+        };
+
+        size_t length = 0;
+        uint32_t keywordHash = keywordHashBasis;
+        NumberShape numberShape = NumberShape::Digits;
+        /**
+         * True if every character after the first two is a hex digit
+         */
+        bool hexDigitTail = true;
+        /**
+         * True if every character after the first two is a bit digit
+         */
+        bool bitDigitTail = true;
+        char text[keywordMaxLength];
+
+        /**
+         * Keywords are ASCII, so other characters are kept as NUL, which no keyword contains.
+         */
+        void push (int32_t ch) {
+            auto byte = static_cast<unsigned char>(
+                ch >= 0 && ch <= CharacterCodes::maxAsciiCharacter ? ch : 0
+            );
+            if (length < keywordMaxLength) {
+                text[length] = static_cast<char>(byte);
+            }
+            keywordHash = keywordHashStep(keywordHash, byte);
+
+            switch (numberShape) {
+                case NumberShape::Digits:
+                    if (!isDigit(ch)) {
+                        numberShape = (
+                            length > 0 && (ch == CharacterCodes::e || ch == CharacterCodes::E) ?
+                            NumberShape::DigitsE :
+                            NumberShape::NotNumber
+                        );
+                    }
+                    break;
+                case NumberShape::DigitsE:
+                    numberShape = isDigit(ch) ? NumberShape::DigitsEDigits : NumberShape::NotNumber;
+                    break;
+                case NumberShape::DigitsEDigits:
+                    if (!isDigit(ch)) {
+                        numberShape = NumberShape::NotNumber;
+                    }
+                    break;
+                case NumberShape::NotNumber:
+                    break;
+            }
+
+            if (length >= 2) {
+                hexDigitTail = hexDigitTail && isHexDigit(ch);
+                bitDigitTail = bitDigitTail && isBitDigit(ch);
+            }
+
+            ++length;
+        }
+
+        bool isAllDigit () const {
+            return length > 0 && numberShape == NumberShape::Digits;
+        }
+
+        /**
+         * Matches `[0-9]+[eE]`
+         */
+        bool isDigitE () const {
+            return numberShape == NumberShape::DigitsE;
+        }
+
+        /**
+         * Matches `[0-9]+[eE][0-9]+`
+         */
+        bool isDigitEDigit () const {
+            return numberShape == NumberShape::DigitsEDigits;
+        }
+
+        /**
+         * Matches `0x[0-9a-fA-F]+`
+         */
+        bool is0xHexLiteral () const {
+            return (
+                length >= 3 &&
+                text[0] == CharacterCodes::_0 &&
+                text[1] == CharacterCodes::x &&
+                hexDigitTail
+            );
+        }
+
+        /**
+         * Matches `0b[01]+`
+         */
+        bool is0bBitLiteral () const {
+            return (
+                length >= 3 &&
+                text[0] == CharacterCodes::_0 &&
+                text[1] == CharacterCodes::b &&
+                bitDigitTail
+            );
+        }
+
+        int tryGetKeywordTokenType () const {
+            if (length > keywordMaxLength) {
+                return -1;
+            }
+            return tryGetKeywordTokenTypeHashed(text, length, keywordHash);
+        }
+    };
+
     /**
      * Unquoted identifiers can be interrupted by custom delimiter.
      * If returned length is zero, there is no unquoted identifier.
+     *
+     * The end is only marked before probing for the custom delimiter,
+     * which only happens when its first character shows up,
+     * and once at the end of the identifier.
      */
-    std::string tryScanUnquotedIdentifier (TmpLexer &lexer, std::string const &customDelimiter) {
+    UnquotedIdentifier tryScanUnquotedIdentifier (TmpLexer &lexer, DelimiterMatcher const &customDelimiter) {
         TmpLexer tmp(lexer);
-        std::string result;
+        UnquotedIdentifier result;
 
         while (!tmp.isEof(0)) {
-            if (customDelimiter.size() > 0) {
-                if (result.size() > 0) {
+            auto ch = tmp.peek(0);
+
+            if (customDelimiter.interruptsUnquotedIdentifier && customDelimiter.mayStartWith(ch)) {
+                if (result.length > 0) {
                     tmp.markEnd();
                     lexer.index = tmp.index;
                 }
@@ -191,19 +390,16 @@ namespace {
                 }
             }
 
-            auto ch = tmp.peek(0);
             if (isUnquotedIdentifierCharacter(ch)) {
-                result += tmp.advance();
+                result.push(tmp.advance());
+                //The end is always marked at or after here
+                tmp.commitIfFar();
             } else {
-                if (result.size() > 0) {
-                    tmp.markEnd();
-                    lexer.index = tmp.index;
-                }
-                return result;
+                break;
             }
         }
 
-        if (result.size() > 0) {
+        if (result.length > 0) {
             tmp.markEnd();
             lexer.index = tmp.index;
         }
@@ -228,14 +424,52 @@ namespace {
      *  B
      *  C`;
      * ```
+     *
+     * Commits as it goes, so a long identifier does not have to be buffered.
+     * If the identifier is unterminated, `lexer` is left behind the committed position,
+     * so callers must return right away.
+     *
+     * Returns false if the identifier is unterminated.
+     *
+     * Reaching EOF sets the bit for `quote` in `unterminatedTokens`.
+     * Scanner state only flows forward, so once it is set there is no closing quote
+     * anywhere after the current position. Later scans with that quote then stop at the
+     * tentative end instead of reading to EOF again, which keeps one stray quote from
+     * making the whole parse quadratic.
      */
-    void scanQuotedIdentifier (TmpLexer &lexer) {
+    /**
+     * Bit for `quote` in `Scanner::unterminatedTokens`
+     */
+    uint8_t quotedIdentifierBit (int32_t quote) {
+        switch (quote) {
+            case CharacterCodes::backtick:
+                return 1;
+            case CharacterCodes::doubleQuote:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+
+    /**
+     * Commits as it goes, like `tryScanQuotedString()`.
+     *
+     * If it does not encounter a closing quote, it returns false,
+     * and the end of the token is marked before the first character that cannot be in
+     * an unquoted identifier (or at EOF, if there is none).
+     * `lexer` is then left behind the committed position, so callers must return right away,
+     * with a result that is not rejected.
+     */
+    bool scanQuotedIdentifier (TmpLexer &lexer, uint8_t &unterminatedTokens) {
         TmpLexer tmp(lexer);
         auto quote = tmp.advance();
+        auto quoteBit = quotedIdentifierBit(quote);
+        auto knownUnterminated = (unterminatedTokens & quoteBit) != 0;
 
         bool foundNonUnquotedIdentifierCharacter = false;
 
         while (!tmp.isEof(0)) {
+            tmp.commitIfFar();
             auto ch = tmp.peek(0);
             if (ch == quote) {
                 if (tmp.peek(1) == quote) {
@@ -247,7 +481,7 @@ namespace {
                     tmp.advance();
                     tmp.markEnd();
                     lexer.index = tmp.index;
-                    return;
+                    return true;
                 }
             } else if (!isUnquotedIdentifierCharacter(ch)) {
                 //Tentatively mark the end of the token here.
@@ -259,12 +493,19 @@ namespace {
                     lexer.index = tmp.index;
                     foundNonUnquotedIdentifierCharacter = true;
                 }
+                if (knownUnterminated) {
+                    //An earlier scan already read to EOF without finding a closing quote,
+                    //so there is none past this point either.
+                    return false;
+                }
                 tmp.advance();
             } else {
                 tmp.advance();
             }
         }
 
+        unterminatedTokens |= quoteBit;
+
         if (!foundNonUnquotedIdentifierCharacter) {
             //We found an EOF and didn't see a line break before.
             //So, we mark the end of the token here.
@@ -272,38 +513,15 @@ namespace {
             tmp.markEnd();
             lexer.index = tmp.index;
         }
-        return;
-    }
-
-    std::regex regexDigitE(
-        "^\\d+[eE]$",
-        std::regex_constants::ECMAScript
-    );
-
-    bool isDigitE (std::string const &str) {
-        return std::regex_match(str, regexDigitE);
-    }
-
-    std::regex regexDigitEDigit(
-        "^\\d+[eE]\\d+",
-        std::regex_constants::ECMAScript
-    );
-
-    bool isDigitEDigit (std::string const &str) {
-        return std::regex_match(str, regexDigitEDigit);
+        return false;
     }
 
     bool tryScanDigitEDigit (TmpLexer &lexer) {
         TmpLexer tmp(lexer);
         //Digit
-        if (!isDigit(tmp.peek(0))) {
+        if (tmp.advanceWhile(CharacterClass::Digit) == 0) {
             return false;
         }
-        tmp.advance();
-
-        while (isDigit(tmp.peek(0))) {
-            tmp.advance();
-        }
 
         //E
         auto chE = tmp.peek(0);
@@ -313,14 +531,9 @@ namespace {
         tmp.advance();
 
         //Digit
-        if (!isDigit(tmp.peek(0))) {
+        if (tmp.advanceWhile(CharacterClass::Digit) == 0) {
             return false;
         }
-        tmp.advance();
-
-        while (isDigit(tmp.peek(0))) {
-            tmp.advance();
-        }
 
         tmp.markEnd();
         lexer.index = tmp.index;
@@ -333,10 +546,7 @@ namespace {
             return false;
         }
         tmp.advance();
-
-        while (isDigit(tmp.peek(0))) {
-            tmp.advance();
-        }
+        tmp.advanceWhile(CharacterClass::Digit);
 
         tmp.markEnd();
         lexer.index = tmp.index;
@@ -353,15 +563,9 @@ namespace {
             tmp.advance();
         }
 
-        auto chFirstDigit = tmp.peek(0);
-        if (!isDigit(chFirstDigit)) {
+        if (tmp.advanceWhile(CharacterClass::Digit) == 0) {
             return false;
         }
-        tmp.advance();
-
-        while (isDigit(tmp.peek(0))) {
-            tmp.advance();
-        }
 
         tmp.markEnd();
         lexer.index = tmp.index;
@@ -379,16 +583,33 @@ namespace {
         return tryScanNumberExponent2(tmp);
     }
 
-    int tryGetKeywordTokenType (std::string const &str) {
-        auto it = keyword2TokenType.find(str);
-        if (it == keyword2TokenType.end()) {
-            return -1;
-        } else {
-            return it->second;
-        }
-    }
-
-    int tryScanIdentifierOrKeywordOrNumberLiteral (TmpLexer &lexer, const bool *valid_symbols, std::string const &customDelimiter) {
+    /**
+     * What `tryScanIdentifierOrKeywordOrNumberLiteral()` does with a keyword
+     * that the parse state does not accept.
+     *
+     * Either way, a non-reserved keyword is an `Identifier` wherever one is accepted.
+     */
+    struct KeywordPolicy {
+        enum Value : uint8_t {
+            /**
+             * Like MySQL, a reserved keyword is never an identifier.
+             * Where it is not accepted, it starts a syntax error.
+             */
+            Strict,
+            /**
+             * A keyword that is not accepted is an `Identifier`, if that is accepted.
+             * One misused reserved word then does not turn its whole statement into an error.
+             */
+            Lenient,
+        };
+    };
+
+    int tryScanIdentifierOrKeywordOrNumberLiteral (
+        TmpLexer &lexer,
+        const bool *valid_symbols,
+        DelimiterMatcher const &customDelimiter,
+        KeywordPolicy::Value keywordPolicy
+    ) {
         TmpLexer tmp(lexer);
         if (!isUnquotedIdentifierCharacter(tmp.peek(0))) {
             return -1;
@@ -407,10 +628,9 @@ namespace {
          * + `0e0`
          * + `0E0`
          */
-        auto str = tryScanUnquotedIdentifier(tmp, customDelimiter);
-        //std::cout << "tryScanIdentifierOrKeywordOrNumberLiteral: " << str << std::endl;
+        auto identifier = tryScanUnquotedIdentifier(tmp, customDelimiter);
 
-        if (str.size() == 0) {
+        if (identifier.length == 0) {
             //No unquoted identifier.
             //We already checked peek(0) is unquoted identifier character.
             //So, we were interrupted by custom delimiter.
@@ -424,7 +644,7 @@ namespace {
             }
         }
 
-        if (isAllDigit(str)) {
+        if (identifier.isAllDigit()) {
             /**
              * + 123
              * + 123.
@@ -451,7 +671,7 @@ namespace {
             }
         }
 
-        if (isDigitE(str)) {
+        if (identifier.isDigitE()) {
             if (tryScanNumberExponent2(tmp)) {
                 return TokenType::RealLiteral;
             } else {
@@ -459,11 +679,11 @@ namespace {
             }
         }
 
-        if (isDigitEDigit(str)) {
+        if (identifier.isDigitEDigit()) {
             return TokenType::RealLiteral;
         }
 
-        auto keywordTokenType = tryGetKeywordTokenType(str);
+        auto keywordTokenType = identifier.tryGetKeywordTokenType();
         if (keywordTokenType < 0) {
             return TokenType::Identifier;
         }
@@ -476,6 +696,14 @@ namespace {
             return TokenType::Identifier;
         }
 
+        if (
+            keywordPolicy == KeywordPolicy::Lenient &&
+            !valid_symbols[keywordTokenType] &&
+            valid_symbols[TokenType::Identifier]
+        ) {
+            return TokenType::Identifier;
+        }
+
         return keywordTokenType;
     }
 }
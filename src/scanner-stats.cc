@@ -0,0 +1,205 @@
+#ifndef SCANNER_STATS_CC
+#define SCANNER_STATS_CC
+#include "./scanner-stats.h"
+#include "./token-kind.cc"
+
+/**
+ * Hot-path counters, compiled in only when `SCANNER_STATS` is defined.
+ */
+#ifdef SCANNER_STATS
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+    static_assert(
+        YOUR_LANGUAGE_NAME_SCANNER_TOKEN_TYPE_COUNT == TokenType::UNIQUE_KEY + 1,
+        "YOUR_LANGUAGE_NAME_SCANNER_TOKEN_TYPE_COUNT must match TokenType"
+    );
+
+    uint64_t readCycleCounter () {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+#endif
+    }
+
+    YourLanguageNameScannerFamily getTokenFamily (int tokenType) {
+        if (tokenType < 0) {
+            return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_OTHER;
+        }
+        if (tokenType < TokenType::END_OF_NON_RESERVED_KEYWORD || tokenType == TokenType::DELIMITER_STATEMENT) {
+            return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_KEYWORD;
+        }
+        switch (tokenType) {
+            case TokenType::Identifier:
+            case TokenType::UserVariableIdentifier:
+            case TokenType::MacroIdentifier:
+                return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_IDENTIFIER;
+            case TokenType::StringLiteral:
+            case TokenType::HexLiteral:
+            case TokenType::BitLiteral:
+            case TokenType::IntegerLiteral:
+            case TokenType::DecimalLiteral:
+            case TokenType::RealLiteral:
+                return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_LITERAL;
+            case TokenType::SingleLineComment:
+            case TokenType::MultiLineComment:
+            case TokenType::ExecutionComment:
+                return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_COMMENT;
+            case TokenType::WhiteSpace:
+            case TokenType::LineBreak:
+                return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_WHITESPACE;
+            case TokenType::CustomDelimiter:
+            case TokenType::SemiColon:
+                return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_DELIMITER;
+            case TokenType::EndOfFile:
+            case TokenType::UnknownToken:
+            case TokenType::UNIQUE_KEY:
+                return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_OTHER;
+            default:
+                return YOUR_LANGUAGE_NAME_SCANNER_FAMILY_OPERATOR;
+        }
+    }
+
+    /**
+     * One per thread.
+     * Only the owning thread writes, but the accessor may read while it runs,
+     * so counters are atomics updated with relaxed load/store pairs (no locked instructions).
+     *
+     * Never freed, so counts from finished threads stay in the totals.
+     */
+    struct ThreadScannerStats {
+        std::atomic<uint64_t> scanCalls;
+        std::atomic<uint64_t> tokens[YOUR_LANGUAGE_NAME_SCANNER_TOKEN_TYPE_COUNT];
+        std::atomic<uint64_t> rejected[YOUR_LANGUAGE_NAME_SCANNER_TOKEN_TYPE_COUNT];
+        std::atomic<uint64_t> charactersConsumed;
+        std::atomic<uint64_t> maxLookahead;
+        std::atomic<uint64_t> familyScans[YOUR_LANGUAGE_NAME_SCANNER_FAMILY_COUNT];
+        std::atomic<uint64_t> familyCycles[YOUR_LANGUAGE_NAME_SCANNER_FAMILY_COUNT];
+
+        /**
+         * Last token type passed to a `lexer*Result()` function during the current `scan()`
+         */
+        int currentTokenType = -1;
+        uint64_t currentScanStart = 0;
+
+        ThreadScannerStats () {
+            reset();
+        }
+
+        void reset () {
+            scanCalls.store(0, std::memory_order_relaxed);
+            for (auto &counter : tokens) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            for (auto &counter : rejected) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            charactersConsumed.store(0, std::memory_order_relaxed);
+            maxLookahead.store(0, std::memory_order_relaxed);
+            for (auto &counter : familyScans) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            for (auto &counter : familyCycles) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        static void bump (std::atomic<uint64_t> &counter, uint64_t amount) {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        static void raise (std::atomic<uint64_t> &counter, uint64_t value) {
+            if (value > counter.load(std::memory_order_relaxed)) {
+                counter.store(value, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct ScannerStatsRegistry {
+        std::mutex mutex;
+        std::vector<ThreadScannerStats *> threads;
+    };
+
+    ScannerStatsRegistry &scannerStatsRegistry () {
+        static ScannerStatsRegistry registry;
+        return registry;
+    }
+
+    ThreadScannerStats &threadScannerStats () {
+        thread_local ThreadScannerStats *stats = nullptr;
+        if (stats == nullptr) {
+            stats = new ThreadScannerStats();
+            auto &registry = scannerStatsRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.threads.push_back(stats);
+        }
+        return *stats;
+    }
+
+    void recordScanStart () {
+        auto &stats = threadScannerStats();
+        ThreadScannerStats::bump(stats.scanCalls, 1);
+        stats.currentTokenType = -1;
+        stats.currentScanStart = readCycleCounter();
+    }
+
+    void recordScanResult (int tokenType, bool accepted) {
+        auto &stats = threadScannerStats();
+        stats.currentTokenType = tokenType;
+        ThreadScannerStats::bump(accepted ? stats.tokens[tokenType] : stats.rejected[tokenType], 1);
+    }
+
+    void recordScanEnd (bool accepted, size_t charactersConsumed, size_t lookahead) {
+        auto cycles = readCycleCounter();
+        auto &stats = threadScannerStats();
+        auto family = getTokenFamily(stats.currentTokenType);
+        ThreadScannerStats::bump(stats.familyScans[family], 1);
+        ThreadScannerStats::bump(stats.familyCycles[family], cycles - stats.currentScanStart);
+        if (accepted) {
+            ThreadScannerStats::bump(stats.charactersConsumed, charactersConsumed);
+        }
+        ThreadScannerStats::raise(stats.maxLookahead, lookahead);
+    }
+
+    void collectScannerStats (YourLanguageNameScannerStats &result) {
+        memset(&result, 0, sizeof(result));
+        auto &registry = scannerStatsRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (auto stats : registry.threads) {
+            result.scan_calls += stats->scanCalls.load(std::memory_order_relaxed);
+            for (size_t i=0; i<YOUR_LANGUAGE_NAME_SCANNER_TOKEN_TYPE_COUNT; ++i) {
+                result.tokens[i] += stats->tokens[i].load(std::memory_order_relaxed);
+                result.rejected[i] += stats->rejected[i].load(std::memory_order_relaxed);
+            }
+            result.characters_consumed += stats->charactersConsumed.load(std::memory_order_relaxed);
+            auto maxLookahead = stats->maxLookahead.load(std::memory_order_relaxed);
+            if (maxLookahead > result.max_lookahead) {
+                result.max_lookahead = maxLookahead;
+            }
+            for (size_t i=0; i<YOUR_LANGUAGE_NAME_SCANNER_FAMILY_COUNT; ++i) {
+                result.family_scans[i] += stats->familyScans[i].load(std::memory_order_relaxed);
+                result.family_cycles[i] += stats->familyCycles[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void resetScannerStats () {
+        auto &registry = scannerStatsRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (auto stats : registry.threads) {
+            stats->reset();
+        }
+    }
+}
+#endif
+#endif
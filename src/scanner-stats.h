@@ -0,0 +1,68 @@
+#ifndef TREE_SITTER_YOUR_LANGUAGE_NAME_SCANNER_STATS_H_
+#define TREE_SITTER_YOUR_LANGUAGE_NAME_SCANNER_STATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Same as the number of `externals` in `externals.js`
+ */
+#define YOUR_LANGUAGE_NAME_SCANNER_TOKEN_TYPE_COUNT 679
+
+typedef enum {
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_KEYWORD,
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_IDENTIFIER,
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_LITERAL,
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_COMMENT,
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_WHITESPACE,
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_DELIMITER,
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_OPERATOR,
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_OTHER,
+    YOUR_LANGUAGE_NAME_SCANNER_FAMILY_COUNT
+} YourLanguageNameScannerFamily;
+
+/**
+ * Counters collected by the external scanner when it is compiled with `SCANNER_STATS` defined.
+ * Totals are summed over every thread that ran the scanner.
+ */
+typedef struct {
+    uint64_t scan_calls;
+    /**
+     * Accepted results, by `TokenType`
+     */
+    uint64_t tokens[YOUR_LANGUAGE_NAME_SCANNER_TOKEN_TYPE_COUNT];
+    /**
+     * Results thrown away because the token was not in `valid_symbols`, by `TokenType`
+     */
+    uint64_t rejected[YOUR_LANGUAGE_NAME_SCANNER_TOKEN_TYPE_COUNT];
+    /**
+     * Characters covered by accepted tokens
+     */
+    uint64_t characters_consumed;
+    /**
+     * Largest number of characters looked at past the current position in one `scan()`
+     */
+    uint64_t max_lookahead;
+    /**
+     * `scan()` calls and the cycles spent in them, by the family of the token they produced,
+     * or tried to produce
+     */
+    uint64_t family_scans[YOUR_LANGUAGE_NAME_SCANNER_FAMILY_COUNT];
+    uint64_t family_cycles[YOUR_LANGUAGE_NAME_SCANNER_FAMILY_COUNT];
+} YourLanguageNameScannerStats;
+
+/**
+ * Returns false, and leaves `stats` alone, if the scanner was compiled without `SCANNER_STATS`.
+ */
+bool tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_stats(YourLanguageNameScannerStats *stats);
+void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,10 +3,12 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstring>
 #include "./token-kind.cc"
 #include "./character-code.cc"
 #include "./buffered-lexer.cc"
 #include "./scan-util.cc"
+#include "./first-byte-table.cc"
 
 namespace {
     struct Scanner {
@@ -15,31 +17,73 @@ namespace {
         static void advance(TSLexer *lexer) { lexer->advance(lexer, false); }
 
         BufferedLexer bufferedLexer;
+        KeywordPolicy::Value keywordPolicy = KeywordPolicy::Strict;
+        /**
+         * If true, `scan(TSLexer *)` skips whitespace and line breaks instead of returning them as tokens,
+         * so they end up as padding of the next token and not as nodes of the tree.
+         * Line breaks are still tokens after `DELIMITER `, where they end the statement.
+         */
+        bool compactExtras = false;
 
         /**
          * If true, the next call to `scan()` should return a custom delimiter token
          */
         bool expectCustomDelimiter = false;
-        std::string customDelimiter;
+        DelimiterMatcher customDelimiter;
+        /**
+         * One bit per quote character (see `quotedIdentifierBit()`),
+         * set once a quoted identifier with that quote was found to be unterminated.
+         * Also `unterminatedStringBit` and `unterminatedMultiLineCommentBit`.
+         */
+        uint8_t unterminatedTokens = 0;
 
+        static_assert(
+            DelimiterMatcher::maxEncodedLength + 1 <= TREE_SITTER_SERIALIZATION_BUFFER_SIZE,
+            "Serialized state must fit in TREE_SITTER_SERIALIZATION_BUFFER_SIZE"
+        );
+
+        /**
+         * The common state (no pending `DELIMITER`, no unterminated tokens,
+         * `;` as the delimiter) serializes to zero bytes.
+         *
+         * Otherwise, one byte of flags followed by the custom delimiter in UTF-8, if any.
+         * + Bit 0 is `expectCustomDelimiter`
+         * + Bits 1 and up are `unterminatedTokens`
+         */
         unsigned serialize (char *buffer) {
-            buffer[0] = expectCustomDelimiter ? '1' : '0';
-            memcpy(buffer+1, customDelimiter.c_str(), sizeof(char)*customDelimiter.size());
+            uint8_t flags = static_cast<uint8_t>(
+                (expectCustomDelimiter ? 1 : 0) |
+                (unterminatedTokens << 1)
+            );
+            if (flags == 0 && customDelimiter.size() == 0) {
+                return 0;
+            }
 
-            return sizeof(char)*customDelimiter.size() + 1;
+            buffer[0] = static_cast<char>(flags);
+            if (customDelimiter.size() > 0) {
+                memcpy(buffer+1, customDelimiter.encodedData(), customDelimiter.encodedSize());
+            }
+            return customDelimiter.encodedSize() + 1;
         }
 
         void deserialize (const char *buffer, unsigned length) {
             if (length == 0) {
                 expectCustomDelimiter = false;
+                unterminatedTokens = 0;
+                customDelimiter.clear();
+                return;
+            }
+
+            auto flags = static_cast<uint8_t>(buffer[0]);
+            expectCustomDelimiter = (flags & 1) != 0;
+            unterminatedTokens = static_cast<uint8_t>(flags >> 1);
+            if (!customDelimiter.compileEncoded(buffer+1, length-1)) {
+                //Not state we serialized, `;` is the best guess
                 customDelimiter.clear();
-            } else {
-                expectCustomDelimiter = buffer[0] == '1';
-                customDelimiter = std::string(buffer+1, length-1);
             }
         }
 
-        bool tryScanOthers (TmpLexer &lexer, const bool *valid_symbols) {
+        bool tryScanDelimiterStatementOrOthers (TmpLexer &lexer, const bool *valid_symbols) {
             TmpLexer tmp(lexer);
 
             if (tryScanStringCaseInsensitive(tmp, "DELIMITER ")) {
@@ -48,12 +92,27 @@ namespace {
                 return lexerResult(tmp.lexer.lexer, valid_symbols, TokenType::DELIMITER_STATEMENT);
             }
 
-            auto tokenType = tryScanIdentifierOrKeywordOrNumberLiteral(tmp, valid_symbols, customDelimiter);
+            return tryScanOthers(tmp, valid_symbols);
+        }
+
+        bool tryScanOthers (TmpLexer &lexer, const bool *valid_symbols) {
+            TmpLexer tmp(lexer);
+
+            auto tokenType = tryScanIdentifierOrKeywordOrNumberLiteral(tmp, valid_symbols, customDelimiter, keywordPolicy);
             if (tokenType < 0) {
                 if (tmp.isEof(0)) {
                     return false;
                 }
                 tmp.advance();
+                //One token for a whole run of garbage, not one per character.
+                //The run ends at anything that starts a token, including line breaks and the delimiter.
+                while (
+                    isUnknownTokenCharacter(tmp.peek(0)) &&
+                    !customDelimiter.mayStartWith(tmp.peek(0))
+                ) {
+                    tmp.commitIfFar();
+                    tmp.advance();
+                }
                 tmp.markEnd();
                 return lexerForcedResult(tmp.lexer.lexer, TokenType::UnknownToken);
             }
@@ -69,6 +128,7 @@ namespace {
                 tmp.advance();
 
                 while (tmp.peek(0) == CharacterCodes::space) {
+                    tmp.commitIfFar();
                     tmp.advance();
                 }
 
@@ -108,29 +168,208 @@ namespace {
              * So, whitespace can be part of delimiter, but cannot be trailing,
              * unless the entire delimiter is whitespace.
              */
-            customDelimiter.clear();
+            int32_t delimiter[DelimiterMatcher::maxLength];
+            size_t delimiterLength = 0;
             while (!tmp.isEof(0) && !isLineBreak(tmp.peek(0))) {
-                customDelimiter += tmp.advance();
+                tmp.commitIfFar();
+                auto ch = tmp.advance();
+                if (delimiterLength < DelimiterMatcher::maxLength) {
+                    delimiter[delimiterLength] = ch;
+                }
+                ++delimiterLength;
             }
 
-            if (customDelimiter.size() == 1 && customDelimiter[0] == ';') {
+            expectCustomDelimiter = false;
+            tmp.markEnd();
+
+            if (delimiterLength == 1 && delimiter[0] == ';') {
                 //This is intentional.
                 //Semicolon is the same as using the "original" delimiter,
                 //Not a custom delimiter.
                 customDelimiter.clear();
+            } else if (!customDelimiter.compile(delimiter, delimiterLength)) {
+                //Too long to keep, so the delimiter in use does not change
+                return lexerForcedResult(tmp.lexer.lexer, TokenType::UnknownToken);
             }
 
-            expectCustomDelimiter = false;
-            tmp.markEnd();
             return lexerResult(tmp.lexer.lexer, valid_symbols, TokenType::CustomDelimiter);
         }
 
+        /**
+         * Stops where the custom delimiter could start, since it may start with whitespace.
+         * Returns true if it skipped anything and reached the end of input.
+         */
+        bool skipWhiteSpaceAndLineBreaks(TSLexer *lexer) {
+            bool skipped = false;
+            while (
+                hasCharacterClass(lexer->lookahead, CharacterClass::WhiteSpace | CharacterClass::LineBreak) &&
+                !customDelimiter.mayStartWith(lexer->lookahead)
+            ) {
+                skip(lexer);
+                skipped = true;
+            }
+            return skipped && lexer->eof(lexer);
+        }
+
         bool scan(TSLexer *lexer, const bool *valid_symbols) {
+#ifdef SCANNER_STATS
+            recordScanStart();
+            auto result = scanCompactOrBuffered(lexer, valid_symbols);
+            recordScanEnd(result, bufferedLexer.tokenLength(), bufferedLexer.lookaheadDepth());
+            return result;
+#else
+            return scanCompactOrBuffered(lexer, valid_symbols);
+#endif
+        }
+
+        bool scanCompactOrBuffered(TSLexer *lexer, const bool *valid_symbols) {
+            //Before `setLexer()`, which marks the end of the token where it starts
+            if (compactExtras && !expectCustomDelimiter && skipWhiteSpaceAndLineBreaks(lexer)) {
+                //Trailing whitespace still needs a token,
+                //or tree-sitter's end of input token would start before it, and leave it out of the tree
+                bufferedLexer.setLexer(lexer);
+                return lexerForcedResult(lexer, TokenType::WhiteSpace);
+            }
+            bufferedLexer.setLexer(lexer);
+            return scanOrResynchronize(lexer, valid_symbols);
+        }
+
+        /**
+         * Same as `scan()`, without going through `TSLexer` callbacks for every character.
+         */
+        bool scan(MemoryLexer &memoryLexer, const bool *valid_symbols) {
+            bufferedLexer.setMemoryLexer(&memoryLexer);
+#ifdef SCANNER_STATS
+            recordScanStart();
+            auto result = scanOrResynchronize(&memoryLexer.lexer, valid_symbols);
+            recordScanEnd(result, bufferedLexer.tokenLength(), bufferedLexer.lookaheadDepth());
+            return result;
+#else
+            return scanOrResynchronize(&memoryLexer.lexer, valid_symbols);
+#endif
+        }
+
+        /**
+         * A token that is not valid in the current parse state starts a syntax error.
+         * It cannot just be rejected: the only token tree-sitter's own lexer knows is the end of input,
+         * and it matches anywhere, so the parse would silently stop here.
+         *
+         * Instead, the rest of the statement, up to the next delimiter, is returned as one `UnknownToken`.
+         * Error recovery then has one token to skip, and picks up again at the delimiter.
+         * While recovering, every token is valid and scanned as usual.
+         */
+        bool scanOrResynchronize(TSLexer *lexer, const bool *valid_symbols) {
+            //Left as is if nothing was scanned
+            lexer->result_symbol = TokenType::EndOfFile;
+            if (scanBuffered(lexer, valid_symbols)) {
+                return true;
+            }
+
+            auto rejected = static_cast<TokenType>(lexer->result_symbol);
+            if (rejected == TokenType::EndOfFile || isErrorRecovery(valid_symbols)) {
+                return false;
+            }
+            if (
+                rejected == TokenType::CustomDelimiter ||
+                rejected == TokenType::DELIMITER_STATEMENT ||
+                (rejected == TokenType::SemiColon && customDelimiter.size() == 0)
+            ) {
+                //Already at the end of a statement
+                return lexerForcedResult(lexer, rejected);
+            }
+
+            //The rejected token has been consumed, carry on from its end
+            TmpLexer tmp(bufferedLexer);
+            skipToDelimiter(tmp);
+            return lexerForcedResult(lexer, TokenType::UnknownToken);
+        }
+
+        /**
+         * Advances up to the next delimiter, `DELIMITER` statement, or the end of input,
+         * and marks the end there.
+         * Strings, quoted identifiers and comments are skipped whole,
+         * because a delimiter inside them does not end the statement.
+         * If one of them is unterminated, the skip ends where that token would have ended.
+         *
+         * The end is marked before looking at anything that could stop the skip,
+         * since looking further ahead moves the end of the token along.
+         */
+        void skipToDelimiter(TmpLexer &tmp) {
+            int32_t previous = 0;
+            while (!tmp.isEof(0)) {
+                tmp.commitIfFar();
+                auto ch = tmp.peek(0);
+
+                if (customDelimiter.size() > 0) {
+                    if (customDelimiter.mayStartWith(ch)) {
+                        tmp.markEnd();
+                        if (tryScanString(tmp, customDelimiter, false)) {
+                            return;
+                        }
+                    }
+                } else if (ch == CharacterCodes::semicolon) {
+                    tmp.markEnd();
+                    return;
+                }
+                if (
+                    (ch == CharacterCodes::d || ch == CharacterCodes::D) &&
+                    !isUnquotedIdentifierCharacter(previous)
+                ) {
+                    tmp.markEnd();
+                    if (tryScanStringCaseInsensitive(tmp, "DELIMITER ", false)) {
+                        return;
+                    }
+                }
+
+                switch (ch) {
+                    case CharacterCodes::singleQuote:
+                        if (!tryScanQuotedString(tmp, unterminatedTokens)) {
+                            return;
+                        }
+                        break;
+                    case CharacterCodes::doubleQuote:
+                    case CharacterCodes::backtick:
+                        if (!scanQuotedIdentifier(tmp, unterminatedTokens)) {
+                            return;
+                        }
+                        break;
+                    case CharacterCodes::pound:
+                        tmp.advance();
+                        tmp.advanceUntilLineBreak();
+                        break;
+                    case CharacterCodes::minus:
+                        tmp.advance();
+                        if (
+                            tmp.peek(0) == CharacterCodes::minus &&
+                            static_cast<uint32_t>(tmp.peek(1)) <= CharacterCodes::space
+                        ) {
+                            tmp.advanceUntilLineBreak();
+                        }
+                        break;
+                    case CharacterCodes::slash:
+                        tmp.advance();
+                        if (tmp.peek(0) == CharacterCodes::asterisk) {
+                            tmp.advance();
+                            if (!tryScanTillEndOfMultiLineComment(tmp, unterminatedTokens)) {
+                                return;
+                            }
+                        }
+                        break;
+                    default:
+                        tmp.advance();
+                        previous = ch;
+                        continue;
+                }
+                previous = 0;
+            }
+            tmp.markEnd();
+        }
+
+        bool scanBuffered(TSLexer *lexer, const bool *valid_symbols) {
             if (lexer->eof(lexer)) {
                 lexer->mark_end(lexer);
                 return lexerResult(lexer, valid_symbols, TokenType::EndOfFile);
             }
-            bufferedLexer.setLexer(lexer);
 
             TmpLexer tmp(bufferedLexer);
 
@@ -138,164 +377,100 @@ namespace {
                 return scanDelimiter(tmp, valid_symbols);
             }
 
-            if (customDelimiter.size() > 0) {
+            if (customDelimiter.mayStartWith(tmp.peek(0))) {
                 if (tryScanString(tmp, customDelimiter)) {
                     return lexerResult(lexer, valid_symbols, TokenType::CustomDelimiter);
                 }
             }
 
-            if (isWhiteSpace(tmp.peek(0))) {
-                tmp.advance();
+            auto firstByte = getFirstByteEntry(tmp.peek(0));
 
-                while (isWhiteSpace(tmp.peek(0))) {
-                    tmp.advance();
-                }
+            switch (firstByte.action) {
+                case FirstByteEntry::WhiteSpace:
+                    tmp.advanceWhileCommitting(CharacterClass::WhiteSpace);
+                    tmp.markEnd();
+                    return lexerResult(lexer, valid_symbols, TokenType::WhiteSpace);
 
-                tmp.markEnd();
-                return lexerResult(lexer, valid_symbols, TokenType::WhiteSpace);
-            }
+                case FirstByteEntry::CarriageReturn:
+                    if (tmp.peek(1) == CharacterCodes::lineFeed) {
+                        tmp.advance();
+                        tmp.advance();
 
-            char ch = tmp.peek(0);
+                        //\r\n
+                        tmp.markEnd();
+                        return lexerResult(lexer, valid_symbols, TokenType::LineBreak);
+                    }
 
-            if (ch == CharacterCodes::carriageReturn) {
-                if (tmp.peek(1) == CharacterCodes::lineFeed) {
-                    tmp.advance();
                     tmp.advance();
 
-                    //\r\n
+                    //\r
                     tmp.markEnd();
                     return lexerResult(lexer, valid_symbols, TokenType::LineBreak);
-                }
-
-                tmp.advance();
-
-                //\r
-                tmp.markEnd();
-                return lexerResult(lexer, valid_symbols, TokenType::LineBreak);
-            }
 
-            if (ch == CharacterCodes::lineFeed) {
-                tmp.advance();
+                case FirstByteEntry::LineFeed:
+                    tmp.advance();
 
-                //\n
-                tmp.markEnd();
-                return lexerResult(lexer, valid_symbols, TokenType::LineBreak);
-            }
+                    //\n
+                    tmp.markEnd();
+                    return lexerResult(lexer, valid_symbols, TokenType::LineBreak);
 
-            //https://dev.mysql.com/doc/refman/5.7/en/hexadecimal-literals.html
-            if (ch == CharacterCodes::x || ch == CharacterCodes::X) {
-                if (tmp.peek(1) == CharacterCodes::singleQuote) {
-                    tmp.advance();
-                    if (tryScanQuotedString(tmp)) {
-                        return lexerResult(lexer, valid_symbols, TokenType::HexLiteral);
-                    } else {
-                        tmp.markEnd();
-                        return lexerEofResult(lexer);
-                    }
-                } else {
-                    return tryScanOthers(tmp, valid_symbols);
-                }
-            }
+                case FirstByteEntry::MaybeDelimiterStatement:
+                    return tryScanDelimiterStatementOrOthers(tmp, valid_symbols);
 
-            if (ch == CharacterCodes::_0) {
-                if (tmp.peek(1) == CharacterCodes::x) {
-                    //String length should never be empty, we confirmed existence of characters 0x
-                    //And 0x... does not match custom delimiter (already tried to match custom delimiter above)
-                    auto str = tryScanUnquotedIdentifier(tmp, customDelimiter);
-                    if (is0xHexLiteral(str)) {
-                        return lexerResult(lexer, valid_symbols, TokenType::HexLiteral);
+                //https://dev.mysql.com/doc/refman/5.7/en/hexadecimal-literals.html
+                case FirstByteEntry::MaybeHexLiteral:
+                    if (tmp.peek(1) == CharacterCodes::singleQuote) {
+                        tmp.advance();
+                        if (tryScanQuotedString(tmp, unterminatedTokens)) {
+                            return lexerResult(lexer, valid_symbols, TokenType::HexLiteral);
+                        } else {
+                            return lexerForcedResult(lexer, TokenType::UnknownToken);
+                        }
                     } else {
-                        return lexerResult(lexer, valid_symbols, TokenType::Identifier);
+                        return tryScanOthers(tmp, valid_symbols);
                     }
-                } else {
-                    return tryScanOthers(tmp, valid_symbols);
-                }
-            }
 
-            //https://dev.mysql.com/doc/refman/5.7/en/bit-value-literals.html
-            if (ch == CharacterCodes::b || ch == CharacterCodes::B) {
-                if (tmp.peek(1) == CharacterCodes::singleQuote) {
-                    tmp.advance();
-                    if (tryScanQuotedString(tmp)) {
-                        return lexerResult(lexer, valid_symbols, TokenType::BitLiteral);
+                //https://dev.mysql.com/doc/refman/5.7/en/bit-value-literals.html
+                case FirstByteEntry::MaybeBitLiteral:
+                    if (tmp.peek(1) == CharacterCodes::singleQuote) {
+                        tmp.advance();
+                        if (tryScanQuotedString(tmp, unterminatedTokens)) {
+                            return lexerResult(lexer, valid_symbols, TokenType::BitLiteral);
+                        } else {
+                            return lexerForcedResult(lexer, TokenType::UnknownToken);
+                        }
                     } else {
-                        tmp.markEnd();
-                        return lexerEofResult(lexer);
+                        return tryScanOthers(tmp, valid_symbols);
                     }
-                } else {
-                    return tryScanOthers(tmp, valid_symbols);
-                }
-            }
 
-            if (ch == CharacterCodes::_0) {
-                if (tmp.peek(1) == CharacterCodes::b) {
-                    //String length should never be empty, we confirmed existence of characters 0b
-                    //And 0b... does not match custom delimiter (already tried to match custom delimiter above)
-                    auto str = tryScanUnquotedIdentifier(tmp, customDelimiter);
-                    if (is0bBitLiteral(str)) {
-                        return lexerResult(lexer, valid_symbols, TokenType::BitLiteral);
+                case FirstByteEntry::Zero:
+                    if (tmp.peek(1) == CharacterCodes::x) {
+                        //String length should never be empty, we confirmed existence of characters 0x
+                        //And 0x... does not match custom delimiter (already tried to match custom delimiter above)
+                        auto identifier = tryScanUnquotedIdentifier(tmp, customDelimiter);
+                        if (identifier.is0xHexLiteral()) {
+                            return lexerResult(lexer, valid_symbols, TokenType::HexLiteral);
+                        } else {
+                            return lexerResult(lexer, valid_symbols, TokenType::Identifier);
+                        }
+                    } else if (tmp.peek(1) == CharacterCodes::b) {
+                        //String length should never be empty, we confirmed existence of characters 0b
+                        //And 0b... does not match custom delimiter (already tried to match custom delimiter above)
+                        auto identifier = tryScanUnquotedIdentifier(tmp, customDelimiter);
+                        if (identifier.is0bBitLiteral()) {
+                            return lexerResult(lexer, valid_symbols, TokenType::BitLiteral);
+                        } else {
+                            return lexerResult(lexer, valid_symbols, TokenType::Identifier);
+                        }
                     } else {
-                        return lexerResult(lexer, valid_symbols, TokenType::Identifier);
+                        return tryScanOthers(tmp, valid_symbols);
                     }
-                } else {
-                    return tryScanOthers(tmp, valid_symbols);
-                }
-            }
 
-            switch (ch) {
-                case CharacterCodes::openBrace:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::OpenBrace);
-                case CharacterCodes::closeBrace:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::CloseBrace);
-                case CharacterCodes::openParen:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::OpenParentheses);
-                case CharacterCodes::closeParen:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::CloseParentheses);
-                case CharacterCodes::caret:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::Caret);
-                case CharacterCodes::asterisk:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::Asterisk);
-                case CharacterCodes::minus:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::Minus);
-                case CharacterCodes::plus:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::Plus);
-                case CharacterCodes::comma:
+                case FirstByteEntry::SingleCharacter:
                     tmp.advance();
                     tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::Comma);
-                case CharacterCodes::bar:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::Bar);
-                case CharacterCodes::equals:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::Equal);
-                case CharacterCodes::semicolon:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::SemiColon);
-                case CharacterCodes::dot:
-                    tmp.advance();
-                    tmp.markEnd();
-                    return lexerResult(lexer, valid_symbols, TokenType::Dot);
-                case CharacterCodes::lessThan:
+                    return lexerResult(lexer, valid_symbols, static_cast<TokenType>(firstByte.tokenType));
+                case FirstByteEntry::LessThan:
                     //<
                     //<<
                     //<>
@@ -336,7 +511,7 @@ namespace {
                             return lexerResult(lexer, valid_symbols, TokenType::Less);
                     }
                     break;
-                case CharacterCodes::greaterThan:
+                case FirstByteEntry::GreaterThan:
                     //>
                     //>>
                     //>=
@@ -360,33 +535,30 @@ namespace {
                             return lexerResult(lexer, valid_symbols, TokenType::Greater);
                     }
                     break;
-                case CharacterCodes::singleQuote:
-                    if (tryScanQuotedString(tmp)) {
+                case FirstByteEntry::SingleQuote:
+                    if (tryScanQuotedString(tmp, unterminatedTokens)) {
                         return lexerResult(lexer, valid_symbols, TokenType::StringLiteral);
                     } else {
-                        tmp.markEnd();
-                        return lexerEofResult(lexer);
+                        return lexerForcedResult(lexer, TokenType::UnknownToken);
                     }
-                case CharacterCodes::slash:
+                case FirstByteEntry::Slash:
                     if (tmp.peek(1) == CharacterCodes::asterisk) {
                         if (tmp.peek(2) == CharacterCodes::exclamation) {
                             tmp.advance();
                             tmp.advance();
                             tmp.advance();
-                            if (tryScanTillEndOfMultiLineComment(tmp)) {
+                            if (tryScanTillEndOfMultiLineComment(tmp, unterminatedTokens)) {
                                 return lexerResult(lexer, valid_symbols, TokenType::ExecutionComment);
                             } else {
-                                tmp.markEnd();
-                                return lexerEofResult(lexer);
+                                return lexerForcedResult(lexer, TokenType::UnknownToken);
                             }
                         } else {
                             tmp.advance();
                             tmp.advance();
-                            if (tryScanTillEndOfMultiLineComment(tmp)) {
+                            if (tryScanTillEndOfMultiLineComment(tmp, unterminatedTokens)) {
                                 return lexerResult(lexer, valid_symbols, TokenType::MultiLineComment);
                             } else {
-                                tmp.markEnd();
-                                return lexerEofResult(lexer);
+                                return lexerForcedResult(lexer, TokenType::UnknownToken);
                             }
                         }
                     } else {
@@ -394,7 +566,32 @@ namespace {
                         tmp.markEnd();
                         return lexerResult(lexer, valid_symbols, TokenType::Slash);
                     }
-                case CharacterCodes::colon:
+                //https://dev.mysql.com/doc/refman/5.7/en/comments.html
+                case FirstByteEntry::Pound:
+                    tmp.advance();
+                    tmp.advanceUntilLineBreak();
+                    tmp.markEnd();
+                    return lexerResult(lexer, valid_symbols, TokenType::SingleLineComment);
+
+                case FirstByteEntry::Minus:
+                    tmp.advance();
+                    //-
+                    //Marked before looking further, because `--` is usually not a comment
+                    tmp.markEnd();
+
+                    //`--` only starts a comment if it is followed by whitespace, a control character, or the end of input
+                    if (
+                        tmp.peek(0) == CharacterCodes::minus &&
+                        static_cast<uint32_t>(tmp.peek(1)) <= CharacterCodes::space
+                    ) {
+                        tmp.advance();
+                        tmp.advanceUntilLineBreak();
+                        tmp.markEnd();
+                        return lexerResult(lexer, valid_symbols, TokenType::SingleLineComment);
+                    }
+                    return lexerResult(lexer, valid_symbols, TokenType::Minus);
+
+                case FirstByteEntry::Colon:
                     if (tmp.peek(1) == CharacterCodes::equals) {
                         tmp.advance();
                         tmp.advance();
@@ -406,7 +603,7 @@ namespace {
                     tmp.markEnd();
                     return lexerResult(lexer, valid_symbols, TokenType::Colon);
 
-                case CharacterCodes::at:
+                case FirstByteEntry::At:
                     if (tmp.peek(1) == CharacterCodes::at) {
                         tmp.advance();
                         tmp.advance();
@@ -420,22 +617,21 @@ namespace {
                         }
 
                         return lexerResult(lexer, valid_symbols, TokenType::AtAt);
-                    } else if (
-                        tmp.peek(1) == CharacterCodes::doubleQuote ||
-                        tmp.peek(1) == CharacterCodes::backtick ||
-                        tmp.peek(1) == CharacterCodes::singleQuote
-                    ) {
+                    } else if (isQuote(tmp.peek(1))) {
                         tmp.advance();
-                        scanQuotedIdentifier(tmp);
-                        return lexerResult(lexer, valid_symbols, TokenType::UserVariableIdentifier);
+                        if (scanQuotedIdentifier(tmp, unterminatedTokens)) {
+                            return lexerResult(lexer, valid_symbols, TokenType::UserVariableIdentifier);
+                        } else {
+                            return lexerForcedResult(lexer, TokenType::UnknownToken);
+                        }
                     } else if (
                         isUnquotedIdentifierCharacter(tmp.peek(1))
                     ) {
                         tmp.advance();
                         tmp.markEnd();
                         //This may be empty.
-                        auto str = tryScanUnquotedIdentifier(tmp, customDelimiter);
-                        if (str.size() == 0) {
+                        auto identifier = tryScanUnquotedIdentifier(tmp, customDelimiter);
+                        if (identifier.length == 0) {
                             /**
                              * @todo Investigate why MySQL allows this,
                              * ```sql
@@ -467,11 +663,16 @@ namespace {
                         tmp.markEnd();
                         return lexerResult(lexer, valid_symbols, TokenType::UserVariableIdentifier);
                     }
-                case CharacterCodes::doubleQuote:
-                case CharacterCodes::backtick:
-                    scanQuotedIdentifier(tmp);
-                    return lexerResult(lexer, valid_symbols, TokenType::Identifier);
-                default:
+                case FirstByteEntry::QuotedIdentifier:
+                    //Unterminated, it ends at its tentative end, like an unterminated string.
+                    //It cannot be rejected: scanning it has already looked ahead to the end of input,
+                    //and the end of a token resynchronized from here could only be marked there.
+                    if (scanQuotedIdentifier(tmp, unterminatedTokens)) {
+                        return lexerResult(lexer, valid_symbols, TokenType::Identifier);
+                    } else {
+                        return lexerForcedResult(lexer, TokenType::UnknownToken);
+                    }
+                case FirstByteEntry::Others:
                     break;
             }
 
@@ -481,8 +682,65 @@ namespace {
 
 }
 
+#include "./tokenizer.cc"
+
+namespace {
+    /**
+     * State used instead of the empty state when tree-sitter starts a parse on this thread.
+     * Lets a parse of one statement start under the `DELIMITER` that is active there.
+     */
+    thread_local char initialState[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+    thread_local unsigned initialStateLength = 0;
+    /**
+     * Settings for scanners on this thread, used from their next scan on
+     */
+    thread_local KeywordPolicy::Value threadKeywordPolicy = KeywordPolicy::Strict;
+    thread_local bool threadCompactExtras = false;
+}
+
 extern "C" {
 
+    /**
+     * Pass `length == 0` to go back to the empty state.
+     * State that is too long, or whose delimiter is longer than `DelimiterMatcher::maxLength`
+     * characters, is rejected the same way.
+     */
+    void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(const char *buffer, unsigned length) {
+        if (
+            length > TREE_SITTER_SERIALIZATION_BUFFER_SIZE ||
+            (length > 0 && !DelimiterMatcher::fitsEncoded(buffer+1, length-1))
+        ) {
+            length = 0;
+        }
+        if (length > 0) {
+            memcpy(initialState, buffer, length);
+        }
+        initialStateLength = length;
+    }
+
+    /**
+     * Pass `true` for `KeywordPolicy::Lenient`, `false` for `KeywordPolicy::Strict` (the default).
+     */
+    void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_lenient_keywords(bool lenient) {
+        threadKeywordPolicy = lenient ? KeywordPolicy::Lenient : KeywordPolicy::Strict;
+    }
+
+    /**
+     * See `Scanner::compactExtras`. Off by default.
+     */
+    void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_compact_extras(bool compact) {
+        threadCompactExtras = compact;
+    }
+
+    /**
+     * Points `buffer` at the state set on this thread, and returns its length (0 for the empty state).
+     * Lets code that parses under its own initial state put back the one it found.
+     */
+    unsigned tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_get_initial_state(const char **buffer) {
+        *buffer = initialState;
+        return initialStateLength;
+    }
+
     void *tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_create() {
         //std::cout << "create" << std::endl;
         auto result = new Scanner();
@@ -500,6 +758,8 @@ extern "C" {
         //std::cout << "scan" << std::endl;
         //std::cout << valid_symbols[TokenType::DATABASE] << std::endl;
         Scanner *scanner = static_cast<Scanner *>(payload);
+        scanner->keywordPolicy = threadKeywordPolicy;
+        scanner->compactExtras = threadCompactExtras;
         return scanner->scan(lexer, valid_symbols);
     }
 
@@ -513,7 +773,29 @@ extern "C" {
         //std::cout << "deserialize" << std::endl;
         //std::cout << length << std::endl;
         Scanner *scanner = static_cast<Scanner *>(payload);
-        scanner->deserialize(buffer, length);
+        //`buffer` is only null before the first external token of a parse.
+        //A token whose state serialized to zero bytes still passes a pointer.
+        if (buffer == nullptr && initialStateLength > 0) {
+            scanner->deserialize(initialState, initialStateLength);
+        } else {
+            scanner->deserialize(buffer, length);
+        }
+    }
+
+    bool tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_stats(YourLanguageNameScannerStats *stats) {
+#ifdef SCANNER_STATS
+        collectScannerStats(*stats);
+        return true;
+#else
+        (void)stats;
+        return false;
+#endif
+    }
+
+    void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_reset_stats(void) {
+#ifdef SCANNER_STATS
+        resetScannerStats();
+#endif
     }
 
 }
@@ -0,0 +1,103 @@
+#include "./stream-parse.h"
+#include <string>
+#include <vector>
+
+namespace {
+    void advancePoint (TSPoint &point, const char *data, size_t length) {
+        for (size_t i=0; i<length; ++i) {
+            if (data[i] == '\n') {
+                ++point.row;
+                point.column = 0;
+            } else {
+                ++point.column;
+            }
+        }
+    }
+
+    struct FileInput {
+        FILE *file;
+        std::vector<char> chunk;
+
+        static const char *read (void *payload, uint32_t, TSPoint, uint32_t *bytesRead) {
+            auto self = static_cast<FileInput *>(payload);
+            *bytesRead = static_cast<uint32_t>(
+                fread(self->chunk.data(), 1, self->chunk.size(), self->file)
+            );
+            return self->chunk.data();
+        }
+    };
+}
+
+namespace YOUR_LANGUAGE_NAME {
+    uint64_t parseStream (TSInput input, StatementCallback const &callback) {
+        TSParser *parser = ts_parser_new();
+        ts_parser_set_language(parser, tree_sitter_YOUR_LANGUAGE_NAME());
+
+        StatementStream stream;
+        uint64_t byteIndex = 0;
+        TSPoint position = { 0, 0 };
+        bool finished = false;
+        uint64_t statementCount = 0;
+
+        const char *previousState;
+        auto previousStateLength = tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_get_initial_state(&previousState);
+        std::string savedState(previousState, previousStateLength);
+
+        Statement statement;
+        const char *text;
+        while (true) {
+            while (stream.next(statement, text)) {
+                TSTree *tree = nullptr;
+                if (statement.length <= UINT32_MAX) {
+                    tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(
+                        statement.scannerState.data(),
+                        static_cast<unsigned>(statement.scannerState.size())
+                    );
+                    tree = ts_parser_parse_string(
+                        parser,
+                        nullptr,
+                        text,
+                        static_cast<uint32_t>(statement.length)
+                    );
+                    //The callback may parse something else on this thread
+                    tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(
+                        savedState.data(),
+                        static_cast<unsigned>(savedState.size())
+                    );
+                }
+                callback(statement, text, tree);
+                if (tree != nullptr) {
+                    ts_tree_delete(tree);
+                }
+                ++statementCount;
+            }
+
+            if (finished) {
+                break;
+            }
+
+            uint32_t bytesRead = 0;
+            auto chunk = input.read(input.payload, static_cast<uint32_t>(byteIndex), position, &bytesRead);
+            if (chunk == nullptr || bytesRead == 0) {
+                stream.finish();
+                finished = true;
+                continue;
+            }
+            stream.append(chunk, bytesRead);
+            advancePoint(position, chunk, bytesRead);
+            byteIndex += bytesRead;
+        }
+
+        ts_parser_delete(parser);
+        return statementCount;
+    }
+
+    uint64_t parseStream (FILE *file, StatementCallback const &callback, size_t chunkSize) {
+        FileInput fileInput{ file, std::vector<char>(chunkSize > 0 ? chunkSize : 1) };
+        TSInput input;
+        input.payload = &fileInput;
+        input.read = FileInput::read;
+        input.encoding = TSInputEncodingUTF8;
+        return parseStream(input, callback);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef TREE_SITTER_YOUR_LANGUAGE_NAME_STREAM_PARSE_H_
+#define TREE_SITTER_YOUR_LANGUAGE_NAME_STREAM_PARSE_H_
+#include <tree_sitter/api.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include "./tokenizer.h"
+
+extern "C" {
+    const TSLanguage *tree_sitter_YOUR_LANGUAGE_NAME(void);
+    void tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_set_initial_state(const char *buffer, unsigned length);
+    unsigned tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_get_initial_state(const char **buffer);
+}
+
+namespace YOUR_LANGUAGE_NAME {
+    /**
+     * Called once per statement, in source order.
+     * `text` holds the statement's `statement.length` bytes,
+     * node positions in `tree` are relative to it.
+     *
+     * Neither outlives the call, the tree is deleted when the callback returns.
+     * `tree` is null for a statement of 4 GiB or more, which is too long for tree-sitter.
+     */
+    typedef std::function<void (Statement const &statement, const char *text, TSTree *tree)> StatementCallback;
+
+    /**
+     * Parses everything `input` returns, one statement at a time,
+     * so dumps far larger than memory can be parsed.
+     * Memory is bounded by the largest statement (see `StatementStream`), not the input.
+     *
+     * `input.read` is called with increasing `byte_index` until it returns zero bytes.
+     * Reads are strictly sequential. `byte_index` is 32 bits and wraps past 4 GiB,
+     * so readers of larger inputs should keep track of their own position.
+     * Only UTF-8 is supported.
+     *
+     * The external scanner starts every statement under the `DELIMITER` active there.
+     * The thread's own initial scanner state is put back before each callback.
+     *
+     * Returns the number of statements.
+     */
+    uint64_t parseStream (TSInput input, StatementCallback const &callback);
+
+    /**
+     * `parseStream()` reading `file` to its end in `chunkSize` byte chunks.
+     */
+    uint64_t parseStream (FILE *file, StatementCallback const &callback, size_t chunkSize = 1 << 20);
+}
+
+#endif
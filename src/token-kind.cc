@@ -1,10 +1,8 @@
 
 #ifndef TOKEN_KIND_CC
 #define TOKEN_KIND_CC
-#include <algorithm>
 #include <vector>
 #include <string>
-#include <map>
 
 namespace {
     enum TokenType {
@@ -1317,27 +1315,12 @@ namespace {
         "YEAR"
     };
 
-    struct ci_less
-    {
-        // case-independent (ci) compare_less binary function
-        struct nocase_compare
-        {
-            bool operator() (const unsigned char& c1, const unsigned char& c2) const {
-                return tolower(c1) < tolower(c2);
-            }
-        };
-        bool operator() (std::string const &s1, std::string const &s2) const {
-            return std::lexicographical_compare(
-                s1.begin(),
-                s1.end(),   // source range
-                s2.begin(),
-                s2.end(),   // dest range
-                nocase_compare()
-            );  // comparison
-        }
+    struct KeywordEntry {
+        const char *text;
+        TokenType tokenType;
     };
 
-    std::map<std::string, TokenType, ci_less> keyword2TokenType = {
+    constexpr KeywordEntry keywordEntries[] = {
         { "ACCESSIBLE", TokenType::ACCESSIBLE },
         { "ADD", TokenType::ADD },
         { "ALL", TokenType::ALL },
@@ -0,0 +1,341 @@
+#ifndef TOKENIZER_CC
+#define TOKENIZER_CC
+#include "./tokenizer.h"
+
+namespace {
+    /**
+     * The tokenizer is not driven by a parse state,
+     * so every token is acceptable everywhere.
+     *
+     * This means non-reserved keywords come out as `Identifier`,
+     * as they do wherever the grammar accepts an identifier.
+     */
+    struct AllValidSymbols {
+        bool values[TokenType::UNIQUE_KEY + 1];
+
+        AllValidSymbols () {
+            for (auto &value : values) {
+                value = true;
+            }
+        }
+    };
+
+    const AllValidSymbols allValidSymbols;
+
+    /**
+     * Calls `callback(tokenType, start, end)` for every token in `data`.
+     * Returns the number of bytes consumed.
+     */
+    template <typename Callback>
+    size_t forEachToken (Scanner &scanner, const char *data, size_t length, Callback callback) {
+        MemoryLexer memoryLexer;
+        memoryLexer.reset(data, length, 0);
+
+        size_t position = 0;
+        while (position < length) {
+            memoryLexer.seek(position);
+            if (!scanner.scan(memoryLexer, allValidSymbols.values)) {
+                break;
+            }
+            if (memoryLexer.end <= memoryLexer.start) {
+                break;
+            }
+
+            auto tokenType = static_cast<TokenType>(memoryLexer.lexer.result_symbol);
+            callback(tokenType, memoryLexer.start, memoryLexer.end);
+            position = memoryLexer.end;
+
+            if (tokenType == TokenType::EndOfFile) {
+                break;
+            }
+        }
+        return position;
+    }
+
+    bool isExtraTokenType (TokenType tokenType) {
+        switch (tokenType) {
+            case TokenType::SingleLineComment:
+            case TokenType::MultiLineComment:
+            case TokenType::ExecutionComment:
+            case TokenType::WhiteSpace:
+            case TokenType::LineBreak:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * Finds statements in a buffer that may still grow at the end.
+     * Offsets are relative to the start of the buffer, `dropFront()` moves that start.
+     *
+     * Scanning resumes at the last token boundary, with the scanner state saved there.
+     * Until the input is final, a token whose scan looked at the end of the buffer
+     * is not trusted, since more input could change it.
+     * Such a token is scanned again once the unscanned part of the buffer has doubled,
+     * so a token that spans many appends is still only scanned a few times.
+     *
+     * A statement is only handed out once the next statement has a token that is not an extra,
+     * because trailing whitespace and comments at the end of the input belong to the last statement.
+     */
+    struct StatementSplitter {
+        typedef YOUR_LANGUAGE_NAME::Statement Statement;
+
+        Scanner scanner;
+        /**
+         * Token boundary where the next scan starts, `scanner` holds the state there
+         */
+        size_t position = 0;
+        /**
+         * Length of the unscanned part of the buffer when scanning last stopped for more input
+         */
+        size_t stalledLength = 0;
+        /**
+         * Set when the scanner could not produce a token before the end of the buffer,
+         * everything from there on goes to the last statement
+         */
+        bool stuck = false;
+        bool done = false;
+
+        size_t statementStart = 0;
+        std::string statementState;
+        /**
+         * True if the current statement has a token that is not an extra
+         */
+        bool hasStatement = false;
+
+        /**
+         * The last statement that ended, held until it is known whether
+         * the rest of the input is only extras
+         */
+        Statement completed;
+        bool hasCompleted = false;
+
+        /**
+         * Bytes before this are not needed anymore
+         */
+        size_t keepFrom () const {
+            return hasCompleted ? completed.offset : statementStart;
+        }
+
+        void dropFront (size_t length) {
+            position -= length;
+            statementStart -= length;
+            if (hasCompleted) {
+                completed.offset -= length;
+            }
+        }
+
+        void flushCompleted (std::vector<Statement> &statements) {
+            if (hasCompleted) {
+                statements.push_back(std::move(completed));
+                hasCompleted = false;
+            }
+        }
+
+        void onToken (TokenType tokenType, size_t end, std::vector<Statement> &statements) {
+            if (isExtraTokenType(tokenType) || tokenType == TokenType::EndOfFile) {
+                return;
+            }
+            flushCompleted(statements);
+            hasStatement = true;
+
+            bool isEndOfStatement = false;
+            if (tokenType == TokenType::CustomDelimiter) {
+                //Ends a `DELIMITER` statement, or a statement under a custom delimiter
+                isEndOfStatement = true;
+            } else if (tokenType == TokenType::SemiColon) {
+                //Under a custom delimiter, semicolons are part of the statement
+                isEndOfStatement = scanner.customDelimiter.size() == 0;
+            }
+
+            if (!isEndOfStatement) {
+                return;
+            }
+
+            completed = Statement{
+                statementStart,
+                end - statementStart,
+                std::move(statementState)
+            };
+            hasCompleted = true;
+
+            char state[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+            statementState.assign(state, scanner.serialize(state));
+            statementStart = end;
+            hasStatement = false;
+        }
+
+        void scan (const char *data, size_t length, bool isFinal, std::vector<Statement> &statements) {
+            if (done) {
+                return;
+            }
+            if (!isFinal && stalledLength > 0 && length - position < stalledLength * 2) {
+                return;
+            }
+            stalledLength = 0;
+
+            MemoryLexer memoryLexer;
+            memoryLexer.reset(data, length, position);
+            char state[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+
+            while (!stuck && position < length) {
+                auto stateLength = scanner.serialize(state);
+                memoryLexer.seek(position);
+                auto scanned = scanner.scan(memoryLexer, allValidSymbols.values);
+
+                if (!isFinal && (memoryLexer.furthest >= length || memoryLexer.sawIncompleteCharacter)) {
+                    //More input could still change this token
+                    scanner.deserialize(state, stateLength);
+                    stalledLength = length - position;
+                    return;
+                }
+                if (!scanned || memoryLexer.end <= memoryLexer.start) {
+                    stuck = true;
+                    break;
+                }
+
+                auto tokenType = static_cast<TokenType>(memoryLexer.lexer.result_symbol);
+                position = memoryLexer.end;
+                onToken(tokenType, position, statements);
+
+                if (tokenType == TokenType::EndOfFile) {
+                    break;
+                }
+            }
+
+            if (!isFinal) {
+                return;
+            }
+            done = true;
+
+            if (statementStart == length) {
+                flushCompleted(statements);
+                return;
+            }
+            if (hasStatement || !hasCompleted) {
+                flushCompleted(statements);
+                statements.push_back(Statement{
+                    statementStart,
+                    length - statementStart,
+                    std::move(statementState)
+                });
+            } else {
+                //Trailing whitespace and comments belong to the last statement
+                completed.length = length - completed.offset;
+                flushCompleted(statements);
+            }
+        }
+    };
+}
+
+namespace YOUR_LANGUAGE_NAME {
+    Tokenizer::Tokenizer () : scanner(new Scanner()) {
+    }
+
+    Tokenizer::~Tokenizer () {
+        delete static_cast<Scanner *>(scanner);
+    }
+
+    size_t Tokenizer::tokenize (const char *data, size_t length, std::vector<Token> &tokens) {
+        return forEachToken(
+            *static_cast<Scanner *>(scanner),
+            data,
+            length,
+            [&tokens] (TokenType tokenType, size_t start, size_t end) {
+                tokens.push_back(Token{
+                    start,
+                    static_cast<uint32_t>(end - start),
+                    static_cast<uint16_t>(tokenType)
+                });
+            }
+        );
+    }
+
+    void Tokenizer::reset () {
+        static_cast<Scanner *>(scanner)->deserialize(nullptr, 0);
+    }
+
+    unsigned Tokenizer::serialize (char *buffer) const {
+        return static_cast<Scanner *>(scanner)->serialize(buffer);
+    }
+
+    void Tokenizer::deserialize (const char *buffer, unsigned length) {
+        static_cast<Scanner *>(scanner)->deserialize(buffer, length);
+    }
+
+    void splitStatements (const char *data, size_t length, std::vector<Statement> &statements) {
+        StatementSplitter splitter;
+        splitter.scan(data, length, /* isFinal */true, statements);
+    }
+
+    void splitStatements (
+        const char *data,
+        size_t length,
+        std::function<void (Statement const &statement)> const &callback
+    ) {
+        //Scanned a window at a time, so only one window's statements are held
+        static const size_t windowLength = 16 * 1024 * 1024;
+
+        StatementSplitter splitter;
+        std::vector<Statement> statements;
+        size_t end = 0;
+        while (end < length) {
+            end = length - end > windowLength ? end + windowLength : length;
+            splitter.scan(data, end, /* isFinal */end == length, statements);
+            for (auto const &statement : statements) {
+                callback(statement);
+            }
+            statements.clear();
+        }
+    }
+
+    StatementStream::StatementStream () : splitter(new StatementSplitter()) {
+    }
+
+    StatementStream::~StatementStream () {
+        delete static_cast<StatementSplitter *>(splitter);
+    }
+
+    void StatementStream::append (const char *data, size_t length) {
+        buffer.append(data, length);
+    }
+
+    void StatementStream::finish () {
+        finished = true;
+    }
+
+    bool StatementStream::next (Statement &statement, const char *&text) {
+        auto &statementSplitter = *static_cast<StatementSplitter *>(splitter);
+
+        if (readyIndex == ready.size()) {
+            ready.clear();
+            readyIndex = 0;
+
+            //Only move the buffer once most of it is no longer needed,
+            //so taking many small statements stays linear
+            auto unneeded = statementSplitter.keepFrom();
+            if (unneeded > 0 && unneeded >= buffer.size() / 2) {
+                buffer.erase(0, unneeded);
+                bufferOffset += unneeded;
+                statementSplitter.dropFront(unneeded);
+            }
+
+            statementSplitter.scan(buffer.data(), buffer.size(), finished, ready);
+            if (ready.empty()) {
+                return false;
+            }
+        }
+
+        statement = ready[readyIndex];
+        ++readyIndex;
+        text = buffer.data() + statement.offset;
+        statement.offset += bufferOffset;
+        return true;
+    }
+
+    size_t StatementStream::bufferedLength () const {
+        return buffer.size();
+    }
+}
+#endif
@@ -0,0 +1,146 @@
+#ifndef TREE_SITTER_YOUR_LANGUAGE_NAME_TOKENIZER_H_
+#define TREE_SITTER_YOUR_LANGUAGE_NAME_TOKENIZER_H_
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Tokenizes SQL without tree-sitter, using the same lexical rules as the external scanner.
+ * Defined in `src/tokenizer.cc`, which is compiled as part of `src/scanner.cc`.
+ */
+namespace YOUR_LANGUAGE_NAME {
+    /**
+     * `tokenType` is the index of the token in `externals` (see `externals.js`).
+     */
+    struct Token {
+        uint64_t offset;
+        uint32_t length;
+        uint16_t tokenType;
+    };
+
+    class Tokenizer {
+        public:
+            Tokenizer ();
+            ~Tokenizer ();
+
+            Tokenizer (Tokenizer const &) = delete;
+            Tokenizer &operator= (Tokenizer const &) = delete;
+
+            /**
+             * Appends the tokens of `data` to `tokens`.
+             * `offset`s are relative to `data`.
+             *
+             * Scanner state (the active `DELIMITER`) carries over from the previous call,
+             * so a document can be fed one statement-aligned chunk at a time.
+             *
+             * Returns the number of bytes consumed. This is less than `length` only if
+             * the scanner could not produce a token there, for example at a NUL byte.
+             *
+             * An unterminated string or comment produces an `UnknownToken` that ends
+             * at its first line break (or the end of `data`), like it does when parsing,
+             * and tokenizing carries on from there.
+             * An unterminated quoted identifier or user variable is an `UnknownToken`
+             * that ends at its first character that could not be in an unquoted identifier.
+             */
+            size_t tokenize (const char *data, size_t length, std::vector<Token> &tokens);
+
+            /**
+             * Forgets any `DELIMITER` seen so far.
+             */
+            void reset ();
+
+            /**
+             * Same format as the external scanner's serialized state.
+             */
+            unsigned serialize (char *buffer) const;
+            void deserialize (const char *buffer, unsigned length);
+
+        private:
+            void *scanner;
+    };
+
+    /**
+     * A byte range of the input that holds one statement,
+     * including the whitespace and comments before it.
+     */
+    struct Statement {
+        uint64_t offset;
+        uint64_t length;
+        /**
+         * Serialized external scanner state at `offset`.
+         * Carries the `DELIMITER` that is active when the statement starts.
+         */
+        std::string scannerState;
+    };
+
+    /**
+     * Appends the statements of `data` to `statements`, in source order.
+     * The statements cover `data` with no gaps.
+     *
+     * A statement ends at `;` when no custom delimiter is active,
+     * at the custom delimiter when one is,
+     * and a `DELIMITER` statement ends at its new delimiter.
+     * Quoted strings, identifiers and comments are skipped the same way the scanner skips them.
+     */
+    void splitStatements (const char *data, size_t length, std::vector<Statement> &statements);
+
+    /**
+     * Same as above, but hands each statement to `callback` as soon as it is found,
+     * so the statements of a huge input never have to be held at once.
+     */
+    void splitStatements (
+        const char *data,
+        size_t length,
+        std::function<void (Statement const &statement)> const &callback
+    );
+
+    /**
+     * `splitStatements()` for input that arrives a piece at a time, like a dump being read from disk.
+     * Only the bytes of statements that have not been taken yet are kept,
+     * so memory is bounded by the largest statement, not the input.
+     */
+    class StatementStream {
+        public:
+            StatementStream ();
+            ~StatementStream ();
+
+            StatementStream (StatementStream const &) = delete;
+            StatementStream &operator= (StatementStream const &) = delete;
+
+            void append (const char *data, size_t length);
+
+            /**
+             * No more input will be appended.
+             * Statements that were waiting for more input can be taken now.
+             */
+            void finish ();
+
+            /**
+             * Takes the next statement, if one is complete.
+             * `statement.offset` counts from the start of the input.
+             * `text` points to the statement's bytes, and is valid until the next call
+             * to `append()` or `next()`.
+             */
+            bool next (Statement &statement, const char *&text);
+
+            /**
+             * Bytes currently held
+             */
+            size_t bufferedLength () const;
+
+        private:
+            void *splitter;
+            std::string buffer;
+            /**
+             * Offset of `buffer[0]` in the input
+             */
+            uint64_t bufferOffset = 0;
+            std::vector<Statement> ready;
+            size_t readyIndex = 0;
+            bool finished = false;
+    };
+}
+
+#endif
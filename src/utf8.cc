@@ -0,0 +1,112 @@
+#ifndef UTF8_CC
+#define UTF8_CC
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+    /**
+     * What tree-sitter puts in `TSLexer::lookahead` for bytes that are not valid UTF-8
+     */
+    const int32_t invalidCodePoint = -1;
+
+    /**
+     * Length of the sequence that `lead` starts, as far as `lead` can tell.
+     * Continuation bytes and invalid lead bytes are one byte long.
+     */
+    inline size_t utf8SequenceLength (unsigned char lead) {
+        if (lead < 0xC2) {
+            return 1;
+        }
+        if (lead < 0xE0) {
+            return 2;
+        }
+        if (lead < 0xF0) {
+            return 3;
+        }
+        if (lead < 0xF5) {
+            return 4;
+        }
+        return 1;
+    }
+
+    /**
+     * Decodes the character at `data`, like tree-sitter does:
+     * anything that is not valid UTF-8 (overlong, surrogate, out of range, cut short)
+     * decodes to `invalidCodePoint`, one byte long.
+     *
+     * Returns the number of bytes read. `length` must be at least 1.
+     */
+    inline size_t decodeUtf8 (const char *data, size_t length, int32_t &codePoint) {
+        auto bytes = reinterpret_cast<const unsigned char *>(data);
+        auto lead = bytes[0];
+        if (lead < 0x80) {
+            codePoint = lead;
+            return 1;
+        }
+
+        auto sequenceLength = utf8SequenceLength(lead);
+        if (sequenceLength == 1 || sequenceLength > length) {
+            codePoint = invalidCodePoint;
+            return 1;
+        }
+
+        //The second byte has a narrower range after some lead bytes
+        unsigned char secondMin = 0x80;
+        unsigned char secondMax = 0xBF;
+        switch (lead) {
+            case 0xE0: secondMin = 0xA0; break;
+            case 0xED: secondMax = 0x9F; break;
+            case 0xF0: secondMin = 0x90; break;
+            case 0xF4: secondMax = 0x8F; break;
+            default: break;
+        }
+        if (bytes[1] < secondMin || bytes[1] > secondMax) {
+            codePoint = invalidCodePoint;
+            return 1;
+        }
+
+        int32_t result = lead & (0x7F >> sequenceLength);
+        for (size_t i=1; i<sequenceLength; ++i) {
+            if ((bytes[i] & 0xC0) != 0x80) {
+                codePoint = invalidCodePoint;
+                return 1;
+            }
+            result = (result << 6) | (bytes[i] & 0x3F);
+        }
+        codePoint = result;
+        return sequenceLength;
+    }
+
+    /**
+     * Writes up to 4 bytes to `buffer`, returns how many.
+     * `invalidCodePoint` is written as the single byte `0xFF`,
+     * which `decodeUtf8()` reads back as `invalidCodePoint`.
+     */
+    inline size_t encodeUtf8 (int32_t codePoint, char *buffer) {
+        if (codePoint < 0 || codePoint > 0x10FFFF) {
+            buffer[0] = static_cast<char>(0xFF);
+            return 1;
+        }
+        if (codePoint < 0x80) {
+            buffer[0] = static_cast<char>(codePoint);
+            return 1;
+        }
+        if (codePoint < 0x800) {
+            buffer[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+            buffer[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            return 2;
+        }
+        if (codePoint < 0x10000) {
+            buffer[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+            buffer[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            buffer[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            return 3;
+        }
+        buffer[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+        buffer[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        buffer[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        buffer[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 4;
+    }
+}
+#endif
@@ -1,4 +1,5 @@
 const tape = require("tape");
+const language = require(".");
 const { parse } = require("./parse");
 
 tape(__filename, t => {
@@ -29,38 +30,342 @@ CREATE SCHEMA D;`;
      *      )
      *  )
      * -----
-     *  
-     * Actual:
-     *  (SourceFile
-     *      (DelimiterStatement (DELIMITER) (CustomDelimiter))
-     *  )
-     * 
-     * With only part of the string parsed.
+     *
+     * Which of the two depends on tree-sitter's error recovery.
+     * Either way, the whole string is parsed, and the error is reported.
      */
     console.log(tree.rootNode.toString())
     console.log("=== end rootNode ==")
 
-    const statements = tree.rootNode.statementNodes;
+    t.deepEqual(
+        tree.rootNode.endPosition,
+        {
+            row : 1,
+            column : 16,
+        }
+    );
+
+    t.deepEqual(
+        tree.rootNode.hasError(),
+        true
+    );
+
+    t.end();
+});
+
+tape(`${__filename} (error stays in its statement)`, t => {
+    /**
+     * `SELECT` is not a statement this grammar knows.
+     * Everything up to its delimiter is one `UnknownToken`,
+     * and parsing picks up again after it.
+     */
+    const sql = `SELECT 'a;b', 1;
+CREATE SCHEMA D;`;
+    const tree = parse(sql);
+
+    console.log(tree.rootNode.toString())
 
     t.deepEqual(
-        statements.length,
-        1
+        tree.rootNode.hasError(),
+        true
     );
 
+    const lastStatement = tree.rootNode.lastNamedChild;
+    t.deepEqual(
+        lastStatement.type,
+        "TrailingStatement"
+    );
+    t.deepEqual(
+        lastStatement.hasError(),
+        false
+    );
+
+    t.end();
+});
+
+tape(`${__filename} (unterminated string)`, t => {
+    /**
+     * The string never closes, so it ends at its first line break as an `UnknownToken`,
+     * instead of taking the rest of the input with it.
+     */
+    const sql = `'never closed
+CREATE SCHEMA D;`;
+    const tree = parse(sql);
+
+    console.log(tree.rootNode.toString())
+
     t.deepEqual(
         tree.rootNode.endPosition,
         {
             row : 1,
-            //Should actually be column 16, I think.
-            column : 0,
+            column : 16,
         }
     );
 
     t.deepEqual(
         tree.rootNode.hasError(),
-        //Should actually be true.
+        true
+    );
+
+    const lastStatement = tree.rootNode.lastNamedChild;
+    t.deepEqual(
+        lastStatement.type,
+        "TrailingStatement"
+    );
+    t.deepEqual(
+        lastStatement.hasError(),
+        false
+    );
+
+    t.end();
+});
+
+tape(`${__filename} (compact extras, delimiter starting with whitespace)`, t => {
+    /**
+     * The tab before `$$` is part of the delimiter, so it must not be skipped as whitespace
+     */
+    const sql = "DELIMITER \t$$\nCREATE SCHEMA a\t$$\nCREATE SCHEMA b\t$$\n";
+    const tree = parse(sql, { compactExtras : true });
+
+    console.log(tree.rootNode.toString())
+
+    t.deepEqual(
+        tree.rootNode.hasError(),
+        false
+    );
+    t.deepEqual(
+        tree.rootNode.namedChildren
+            .map(node => node.type)
+            .filter(type => type != "WhiteSpace" && type != "LineBreak"),
+        [
+            "DelimiterStatement",
+            "LeadingStatement",
+            "TrailingStatement",
+        ]
+    );
+    t.deepEqual(
+        tree.rootNode.namedChildren.filter(node => node.type == "LineBreak").length,
+        0
+    );
+
+    t.end();
+});
+
+tape(`${__filename} (unterminated quoted identifier)`, t => {
+    /**
+     * The backtick never closes, so it is an `UnknownToken`
+     * that ends before its first character that could not be in an unquoted identifier,
+     * and the statement after it still parses.
+     */
+    for (const sql of [
+        "`abc def;\nCREATE SCHEMA D;",
+        "@`abc def;\nCREATE SCHEMA D;",
+    ]) {
+        const tree = parse(sql);
+
+        console.log(tree.rootNode.toString())
+
+        t.deepEqual(
+            tree.rootNode.endPosition,
+            {
+                row : 1,
+                column : 16,
+            }
+        );
+
+        t.deepEqual(
+            tree.rootNode.hasError(),
+            true
+        );
+
+        const lastStatement = tree.rootNode.lastNamedChild;
+        t.deepEqual(
+            lastStatement.type,
+            "TrailingStatement"
+        );
+        t.deepEqual(
+            lastStatement.hasError(),
+            false
+        );
+    }
+
+    t.end();
+});
+
+tape(`${__filename} (longest delimiter)`, t => {
+    /**
+     * 255 characters is the longest delimiter the scanner can keep
+     */
+    const delimiter = "|".repeat(255);
+    const tree = parse(`DELIMITER ${delimiter}
+CREATE SCHEMA a${delimiter}`);
+
+    console.log(tree.rootNode.toString())
+
+    t.deepEqual(
+        tree.rootNode.hasError(),
         false
     );
 
     t.end();
 });
+
+tape(`${__filename} (delimiter too long)`, t => {
+    /**
+     * One character more is an error, not a truncated delimiter,
+     * and `;` stays the delimiter.
+     */
+    const delimiter = "|".repeat(256);
+    const tree = parse(`DELIMITER ${delimiter}
+CREATE SCHEMA a;`);
+
+    console.log(tree.rootNode.toString())
+
+    t.deepEqual(
+        tree.rootNode.hasError(),
+        true
+    );
+
+    const lastStatement = tree.rootNode.lastNamedChild;
+    t.deepEqual(
+        lastStatement.type,
+        "TrailingStatement"
+    );
+    t.deepEqual(
+        lastStatement.hasError(),
+        false
+    );
+
+    t.end();
+});
+
+tape(`${__filename} (parseStatements keeps the caller's initial state)`, t => {
+    /**
+     * The calling thread parses some of the statements,
+     * each under the `DELIMITER` active where it starts,
+     * and must get its own initial scanner state back afterwards.
+     */
+    const callerState = Buffer.from("\0$$");
+    language.setInitialState(callerState);
+    try {
+        const statements = language.parseStatements(
+            "DELIMITER //\nCREATE SCHEMA a//\nDELIMITER ;\nCREATE SCHEMA b;",
+            2
+        );
+
+        t.deepEqual(
+            statements.map(statement => statement.hasError),
+            [false, false, false, false]
+        );
+        t.deepEqual(
+            language.getInitialState(),
+            callerState
+        );
+        t.deepEqual(
+            parse("CREATE SCHEMA c$$").rootNode.hasError(),
+            false
+        );
+    } finally {
+        language.setInitialState(null);
+    }
+
+    t.end();
+});
+
+tape(`${__filename} (parseStream keeps the caller's initial state)`, t => {
+    /**
+     * The callback runs on the parsing thread, between statements,
+     * and may parse something else under the thread's own initial scanner state.
+     */
+    const callerState = Buffer.from("\0$$");
+    language.setInitialState(callerState);
+    try {
+        const seen = [];
+        const statementCount = language.parseStream(
+            "DELIMITER //\nCREATE SCHEMA a//\nCREATE SCHEMA b//",
+            statement => {
+                seen.push({
+                    hasError : statement.hasError,
+                    initialState : language.getInitialState(),
+                    nestedHasError : parse("CREATE SCHEMA c$$").rootNode.hasError(),
+                });
+            }
+        );
+
+        t.deepEqual(
+            statementCount,
+            3
+        );
+        t.deepEqual(
+            seen,
+            Array(3).fill({
+                hasError : false,
+                initialState : callerState,
+                nestedHasError : false,
+            })
+        );
+    } finally {
+        language.setInitialState(null);
+    }
+
+    t.end();
+});
+
+tape(`${__filename} (chunked document)`, t => {
+    /**
+     * Small chunks, so the `DELIMITER` carries over chunk boundaries.
+     * Positions are relative to the whole document,
+     * and the caller's initial scanner state is back after every chunk.
+     */
+    const sql = "DELIMITER //\nCREATE SCHEMA a//\nCREATE SCHEMA b//\nDELIMITER ;\nCREATE SCHEMA c;";
+    const callerState = Buffer.from("\0$$");
+    language.setInitialState(callerState);
+    try {
+        const document = language.chunkedDocument(sql, 16);
+
+        t.deepEqual(
+            document.chunks.length > 1,
+            true
+        );
+        t.deepEqual(
+            document.nodes.some(node => node.hasError),
+            false
+        );
+        t.deepEqual(
+            Math.max(...document.nodes.map(node => node.endByte)),
+            sql.length
+        );
+        t.deepEqual(
+            language.chunkedDocumentDescendant(sql, 16, sql.indexOf("c;"), sql.indexOf("c;") + 1),
+            {
+                type : "Identifier",
+                startByte : sql.indexOf("c;"),
+                endByte : sql.indexOf("c;") + 1,
+                hasError : false,
+            }
+        );
+        t.deepEqual(
+            language.getInitialState(),
+            callerState
+        );
+    } finally {
+        language.setInitialState(null);
+    }
+
+    /**
+     * An empty document has no chunks, and no node to find
+     */
+    t.deepEqual(
+        language.chunkedDocument("", 16),
+        {
+            chunks : [],
+            nodes : [],
+        }
+    );
+    t.deepEqual(
+        language.chunkedDocumentDescendant("", 16, 0, 0),
+        null
+    );
+
+    t.end();
+});
@@ -0,0 +1,159 @@
+/**
+ * Checks that the external scanner does not allocate once it is warmed up.
+ *
+ * Scans the same input twice through a minimal `TSLexer`, like tree-sitter would,
+ * deserializing and serializing around every token.
+ * The first pass may grow buffers; the second must not allocate at all.
+ *
+ * Exits with status 1 and prints the allocation count if it did.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "scanner.cc"
+
+namespace {
+    bool countAllocations = false;
+    size_t allocationCount = 0;
+
+    /**
+     * Byte-wise, so only used with ASCII input.
+     */
+    struct StringLexer {
+        TSLexer base;
+        std::string const *input;
+        size_t position;
+        size_t end;
+    };
+
+    int32_t lookaheadAt (std::string const &input, size_t position) {
+        return position < input.size() ? static_cast<unsigned char>(input[position]) : 0;
+    }
+
+    void stringLexerAdvance (TSLexer *lexer, bool skip) {
+        auto stringLexer = reinterpret_cast<StringLexer *>(lexer);
+        if (stringLexer->position < stringLexer->input->size()) {
+            ++stringLexer->position;
+        }
+        if (skip) {
+            stringLexer->end = stringLexer->position;
+        }
+        lexer->lookahead = lookaheadAt(*stringLexer->input, stringLexer->position);
+    }
+
+    void stringLexerMarkEnd (TSLexer *lexer) {
+        auto stringLexer = reinterpret_cast<StringLexer *>(lexer);
+        stringLexer->end = stringLexer->position;
+    }
+
+    uint32_t stringLexerGetColumn (TSLexer *) {
+        return 0;
+    }
+
+    bool stringLexerIsAtIncludedRangeStart (const TSLexer *) {
+        return false;
+    }
+
+    bool stringLexerEof (const TSLexer *lexer) {
+        auto stringLexer = reinterpret_cast<StringLexer const *>(lexer);
+        return stringLexer->position >= stringLexer->input->size();
+    }
+
+    /**
+     * Returns the number of tokens, or 0 if the scanner stopped before the end of `input`.
+     */
+    size_t scanAll (void *scanner, std::string const &input, const bool *validSymbols) {
+        char state[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+        unsigned stateLength = 0;
+        size_t position = 0;
+        size_t tokenCount = 0;
+        while (true) {
+            StringLexer lexer;
+            lexer.base.lookahead = lookaheadAt(input, position);
+            lexer.base.result_symbol = 0;
+            lexer.base.advance = stringLexerAdvance;
+            lexer.base.mark_end = stringLexerMarkEnd;
+            lexer.base.get_column = stringLexerGetColumn;
+            lexer.base.is_at_included_range_start = stringLexerIsAtIncludedRangeStart;
+            lexer.base.eof = stringLexerEof;
+            lexer.input = &input;
+            lexer.position = position;
+            lexer.end = position;
+
+            tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_deserialize(scanner, state, stateLength);
+            if (!tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_scan(scanner, &lexer.base, validSymbols)) {
+                return 0;
+            }
+            stateLength = tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_serialize(scanner, state);
+            if (lexer.base.result_symbol == TokenType::EndOfFile) {
+                return tokenCount;
+            }
+            if (lexer.end == position) {
+                return 0;
+            }
+            ++tokenCount;
+            position = lexer.end;
+        }
+    }
+}
+
+void *operator new (size_t size) {
+    if (countAllocations) {
+        ++allocationCount;
+    }
+    void *result = malloc(size == 0 ? 1 : size);
+    //node-gyp builds with -fno-exceptions, so running out of memory cannot throw
+    if (result == nullptr) {
+        fprintf(stderr, "Out of memory allocating %zu bytes\n", size);
+        abort();
+    }
+    return result;
+}
+
+void operator delete (void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete (void *pointer, size_t) noexcept {
+    free(pointer);
+}
+
+int main () {
+    //Mostly identifiers and keywords, with a few tokens longer than the inline lookahead buffer
+    std::string input;
+    for (size_t i=0; i<1000; ++i) {
+        input += "CREATE SCHEMA IF NOT EXISTS customer_orders_" + std::to_string(i);
+        input += " DEFAULT CHARACTER SET = utf8mb4 DEFAULT COLLATE = utf8mb4_unicode_ci;\n";
+        if (i % 100 == 0) {
+            input += "/* a comment that is a good deal longer than sixty-four bytes of lookahead */\n";
+            input += "DELIMITER $$\nCREATE SCHEMA `quoted identifier " + std::to_string(i) + "`$$\nDELIMITER ;\n";
+        }
+    }
+
+    //What tree-sitter passes outside of error recovery
+    bool validSymbols[TokenType::UNIQUE_KEY + 1];
+    for (auto &valid : validSymbols) {
+        valid = true;
+    }
+    validSymbols[TokenType::START_OF_RESERVED_KEYWORD] = false;
+
+    void *scanner = tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_create();
+    auto warmUpTokenCount = scanAll(scanner, input, validSymbols);
+
+    countAllocations = true;
+    auto tokenCount = scanAll(scanner, input, validSymbols);
+    countAllocations = false;
+
+    tree_sitter_YOUR_LANGUAGE_NAME_external_scanner_destroy(scanner);
+
+    if (warmUpTokenCount == 0 || tokenCount != warmUpTokenCount) {
+        fprintf(stderr, "Scanning stopped early (%zu, then %zu tokens)\n", warmUpTokenCount, tokenCount);
+        return 1;
+    }
+    if (allocationCount != 0) {
+        fprintf(stderr, "%zu allocations in %zu tokens after warm-up\n", allocationCount, tokenCount);
+        return 1;
+    }
+    printf("0 allocations in %zu tokens after warm-up\n", tokenCount);
+    return 0;
+}